@@ -0,0 +1,904 @@
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include "Catalog.h"
+#include "Checksum.h"
+
+namespace GMS {
+
+	//the header of a catalog file
+	struct CatalogHeader {
+		char magic[4];
+		unsigned int version;
+		unsigned int block_records;
+		unsigned int unit_count;
+		unsigned long long record_count;
+		unsigned long long name_count;
+		unsigned long long units_offset;
+		unsigned long long index_offset;
+		unsigned long long checksum;
+		unsigned long long reserved;
+	};
+
+	static_assert(sizeof(CatalogHeader) == 64, "catalog header must be 64 bytes");
+	static_assert(sizeof(CatalogBlock) == 32, "catalog index entry must be 32 bytes");
+
+	static const char catalog_magic[4] = { 'G', 'M', 'S', 'C' };
+
+	//the flags of a record, four bits each
+	static const unsigned perishable_flag = 1;
+	static const unsigned taxed_flag = 2;
+	static const unsigned cents_flag = 4;
+	static const unsigned dated_flag = 8;
+
+	//the number of variable-width columns of a record block, whose sizes start the block
+	static const int column_count = 6;
+	enum Column { sku_column, name_column, unit_column, quantity_column, price_column, date_column };
+
+	//the shortest match the block coding refers back to, and the size of its hash table of recent positions
+	static const size_t min_match = 4;
+	static const int match_hash_bits = 14;
+
+	static void put(std::vector<unsigned char>& out, unsigned long long value)
+	{
+		while (value >= 0x80) {
+			out.push_back((unsigned char)(value | 0x80));
+			value >>= 7;
+		}
+		out.push_back((unsigned char)value);
+	}
+
+	//reads a varint at p, advancing p, and returns false if it runs past last or is longer than 64 bits
+	static bool get(const unsigned char*& p, const unsigned char* last, unsigned long long& value)
+	{
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (p == last)
+				return false;
+			unsigned char byte = *p++;
+			value |= (unsigned long long)(byte & 0x7F) << shift;
+			if ((byte & 0x80) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	static unsigned long long zigzag(long long value)
+	{
+		return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+	}
+
+	static long long unzigzag(unsigned long long value)
+	{
+		return (long long)(value >> 1) ^ -(long long)(value & 1);
+	}
+
+	//packs the sku big-endian into 64 bits, so that the keys of two skus compare as the skus do under strcmp
+	static unsigned long long skuKey(const char* sku)
+	{
+		unsigned long long key = 0;
+		bool ended = sku == nullptr;
+		for (int i = 0; i < 8; ++i) {
+			unsigned char c = 0;
+			if (!ended && i < max_sku_length) {
+				c = static_cast<unsigned char>(sku[i]);
+				ended = c == 0;
+			}
+			key = key << 8 | c;
+		}
+		return key;
+	}
+
+	//the expiry date as a single number (0 if there is none), and back
+	static unsigned long long dateKey(const Date& date)
+	{
+		int year, month, day;
+		date.extract(year, month, day);
+		return year != 0 ? (unsigned long long)year << 9 | (unsigned long long)month << 5 | (unsigned long long)day : 0;
+	}
+
+	static Date keyDate(unsigned long long key)
+	{
+		return Date((int)(key >> 9), (int)(key >> 5 & 15), (int)(key & 31));
+	}
+
+	/*returns true and the price in cents if the price is a whole number of cents that divides back to exactly the
+	same double, which holds for every price read from two decimals*/
+	static bool priceCents(double price, long long& cents)
+	{
+		double scaled = price * 100.0;
+		if (!(std::fabs(scaled) < 9007199254740992.0))
+			return false;
+		cents = std::llround(scaled);
+		double back = (double)cents / 100.0;
+		return memcmp(&back, &price, sizeof(price)) == 0;
+	}
+
+	//the fields of a product as saveCatalog encodes them, with its name and unit replaced by their dictionary ids
+	struct CatalogEntry {
+		unsigned long long key;
+		double price;
+		unsigned long long date;
+		size_t name;
+		unsigned int unit;
+		int quantity;
+		int needed;
+		unsigned int bits;
+	};
+
+	/*A dictionary of distinct strings, numbered in order of first use. The strings are kept null-terminated one after
+	the other and found through an open-addressing hash table of their ids.*/
+	class Dictionary {
+
+		std::vector<char> text;
+		std::vector<size_t> starts;
+		std::vector<size_t> lengths;
+		//the table: id + 1 of a string, 0 marks an empty slot
+		std::vector<size_t> table;
+
+		static size_t hashOf(const char* s, size_t length)
+		{
+			size_t hash = (size_t)14695981039346656037ULL;
+			for (size_t i = 0; i < length; ++i)
+				hash = (hash ^ static_cast<unsigned char>(s[i])) * (size_t)1099511628211ULL;
+			return hash ^ (hash >> 29);
+		}
+
+		void rehash(size_t capacity)
+		{
+			table.assign(capacity, 0);
+			for (size_t id = 0; id < starts.size(); ++id) {
+				size_t slot = hashOf(at(id), lengths[id]) & (capacity - 1);
+				while (table[slot] != 0)
+					slot = (slot + 1) & (capacity - 1);
+				table[slot] = id + 1;
+			}
+		}
+
+	public:
+
+		//returns the id of the string, adding it if it is not in the dictionary yet
+		size_t add(const char* s, size_t length)
+		{
+			if ((starts.size() + 1) * 10 > table.size() * 7)
+				rehash(table.empty() ? 1024 : table.size() * 2);
+			size_t mask = table.size() - 1;
+			size_t slot = hashOf(s, length) & mask;
+			while (table[slot] != 0) {
+				size_t id = table[slot] - 1;
+				if (lengths[id] == length && memcmp(at(id), s, length) == 0)
+					return id;
+				slot = (slot + 1) & mask;
+			}
+			table[slot] = starts.size() + 1;
+			starts.push_back(text.size());
+			lengths.push_back(length);
+			text.insert(text.end(), s, s + length);
+			text.push_back('\0');
+			return starts.size() - 1;
+		}
+
+		size_t size() const
+		{
+			return starts.size();
+		}
+
+		const char* at(size_t id) const
+		{
+			return text.data() + starts[id];
+		}
+
+		size_t length(size_t id) const
+		{
+			return lengths[id];
+		}
+	};
+
+	/*compresses n bytes into out with a greedy LZ77 coding: a sequence of tokens, each a varint count of literals and
+	the literals, followed (except at the end of the input) by a match: a varint of its length less min_match and a
+	varint of its distance back into the output*/
+	static void compress(const unsigned char* in, size_t n, std::vector<unsigned char>& out)
+	{
+		out.clear();
+		std::vector<unsigned int> recent((size_t)1 << match_hash_bits, 0);
+		size_t anchor = 0;
+		size_t i = 0;
+		while (i + min_match <= n) {
+			unsigned int word;
+			memcpy(&word, in + i, sizeof(word));
+			size_t hash = (word * 2654435761u) >> (32 - match_hash_bits);
+			size_t candidate = recent[hash];
+			recent[hash] = (unsigned int)(i + 1);
+			unsigned int previous = ~word;
+			if (candidate != 0)
+				memcpy(&previous, in + candidate - 1, sizeof(previous));
+			if (previous == word) {
+				size_t from = candidate - 1;
+				size_t length = min_match;
+				while (i + length < n && in[from + length] == in[i + length])
+					++length;
+				put(out, i - anchor);
+				out.insert(out.end(), in + anchor, in + i);
+				put(out, length - min_match);
+				put(out, i - from);
+				i += length;
+				anchor = i;
+			}
+			else
+				++i;
+		}
+		put(out, n - anchor);
+		out.insert(out.end(), in + anchor, in + n);
+	}
+
+	//expands the coding of compress into exactly n bytes at out and returns false if it is not a coding of n bytes
+	static bool uncompress(const unsigned char* p, const unsigned char* last, unsigned char* out, size_t n)
+	{
+		size_t used = 0;
+		for (;;) {
+			unsigned long long literals, length, distance;
+			if (!get(p, last, literals) || literals > n - used || literals > (size_t)(last - p))
+				return false;
+			if (literals != 0)
+				memcpy(out + used, p, (size_t)literals);
+			p += literals;
+			used += (size_t)literals;
+			if (used == n)
+				return p == last;
+			if (!get(p, last, length) || !get(p, last, distance) || distance == 0 || distance > used ||
+				n - used < min_match || length > n - used - min_match)
+				return false;
+			length += min_match;
+			const unsigned char* from = out + used - distance;
+			unsigned char* to = out + used;
+			for (size_t k = 0; k < length; ++k)
+				to[k] = from[k];
+			used += (size_t)length;
+		}
+	}
+
+	/*A BlockCursor walks the records of an expanded record block, all of its columns in step. Moving to a record
+	decodes its numbers; only copying it builds the ProductRecord, so a lookup skips the records before the one it
+	wants cheaply.*/
+	class BlockCursor {
+
+		const std::vector<std::string>& units;
+		const unsigned char* flags;
+		const unsigned char* cursors[column_count];
+		const unsigned char* ends[column_count];
+		size_t count;
+		size_t index;
+		size_t length;
+		unsigned bits;
+		unsigned long long unit;
+		long long quantity;
+		long long needed;
+		double price;
+		unsigned long long date;
+
+		//moves past a number of varints in a column and returns false if the column ends first
+		static bool skipVarints(const unsigned char*& p, const unsigned char* end, size_t n)
+		{
+			while (n != 0 && p != end)
+				n -= *p++ < 0x80 ? 1 : 0;
+			return n == 0;
+		}
+
+		//moves to the next record and decodes its sku only
+		bool nextSku()
+		{
+			if (index == count)
+				return false;
+			++index;
+
+			const unsigned char*& p = cursors[sku_column];
+			if (p == ends[sku_column])
+				return false;
+			size_t shared = *p >> 4;
+			size_t rest = *p++ & 15;
+			if (shared > length || shared + rest > (size_t)max_sku_length || rest > (size_t)(ends[sku_column] - p))
+				return false;
+			memcpy(sku + shared, p, rest);
+			p += rest;
+			length = shared + rest;
+			sku[length] = '\0';
+			return true;
+		}
+
+		//decodes the fields other than the sku of the given record, the one following the records already decoded
+		bool fields(size_t record)
+		{
+			bits = flags[record / 2] >> (record % 2 * 4) & 15;
+			unsigned long long onHand, wanted;
+			if (!get(cursors[name_column], ends[name_column], name) ||
+				!get(cursors[unit_column], ends[unit_column], unit) || unit >= units.size() ||
+				!get(cursors[quantity_column], ends[quantity_column], onHand) ||
+				!get(cursors[quantity_column], ends[quantity_column], wanted))
+				return false;
+			quantity = unzigzag(onHand);
+			needed = unzigzag(wanted);
+			if (quantity != (int)quantity || needed != (int)needed)
+				return false;
+
+			if ((bits & cents_flag) != 0) {
+				unsigned long long cents;
+				if (!get(cursors[price_column], ends[price_column], cents))
+					return false;
+				price = (double)unzigzag(cents) / 100.0;
+			}
+			else {
+				if ((size_t)(ends[price_column] - cursors[price_column]) < sizeof(price))
+					return false;
+				memcpy(&price, cursors[price_column], sizeof(price));
+				cursors[price_column] += sizeof(price);
+			}
+
+			if ((bits & dated_flag) != 0) {
+				unsigned long long delta;
+				if (!get(cursors[date_column], ends[date_column], delta))
+					return false;
+				date += (unsigned long long)unzigzag(delta);
+			}
+			return true;
+		}
+
+		/*moves past the fields other than the sku of the records [first, last): the varints of the ids, quantities and
+		prices are only counted, and only the date differences are added up*/
+		bool skip(size_t first, size_t last)
+		{
+			size_t n = last - first;
+			if (!skipVarints(cursors[name_column], ends[name_column], n) ||
+				!skipVarints(cursors[unit_column], ends[unit_column], n) ||
+				!skipVarints(cursors[quantity_column], ends[quantity_column], 2 * n))
+				return false;
+			for (size_t record = first; record < last; ++record) {
+				unsigned flag = flags[record / 2] >> (record % 2 * 4);
+				if ((flag & cents_flag) != 0) {
+					if (!skipVarints(cursors[price_column], ends[price_column], 1))
+						return false;
+				}
+				else {
+					if ((size_t)(ends[price_column] - cursors[price_column]) < sizeof(price))
+						return false;
+					cursors[price_column] += sizeof(price);
+				}
+				if ((flag & dated_flag) != 0) {
+					unsigned long long delta;
+					if (!get(cursors[date_column], ends[date_column], delta))
+						return false;
+					date += (unsigned long long)unzigzag(delta);
+				}
+			}
+			return true;
+		}
+
+	public:
+
+		//the sku and the name id of the current record
+		char sku[max_sku_length + 1];
+		unsigned long long name;
+
+		explicit BlockCursor(const std::vector<std::string>& units_) : units(units_), flags(nullptr), count(0), index(0)
+		{
+		}
+
+		//starts before the first record and returns false if the block is not laid out as the given number of records
+		bool start(const std::vector<unsigned char>& buffer, size_t count_)
+		{
+			const unsigned char* p = buffer.data();
+			const unsigned char* last = p + buffer.size();
+			unsigned long long sizes[column_count];
+			for (unsigned long long& size : sizes) {
+				if (!get(p, last, size))
+					return false;
+			}
+			if ((size_t)(last - p) < (count_ + 1) / 2)
+				return false;
+			flags = p;
+			p += (count_ + 1) / 2;
+			for (int c = 0; c < column_count; ++c) {
+				if (sizes[c] > (size_t)(last - p))
+					return false;
+				cursors[c] = p;
+				p += sizes[c];
+				ends[c] = p;
+			}
+			count = count_;
+			index = 0;
+			length = 0;
+			date = 0;
+			sku[0] = '\0';
+			return p == last;
+		}
+
+		//moves to the next record and returns false at the end of the block or if the record cannot be decoded
+		bool next()
+		{
+			return nextSku() && fields(index - 1);
+		}
+
+		/*moves to the first record whose sku is not below the key, decoding only the skus of the records before it and
+		skipping their other fields, and returns false if there is no such record or it cannot be decoded*/
+		bool seek(unsigned long long key)
+		{
+			size_t from = index;
+			while (nextSku()) {
+				if (skuKey(sku) >= key)
+					return skip(from, index - 1) && fields(index - 1);
+			}
+			return false;
+		}
+
+		//copies the current record, all but its name, into the record
+		void copy(ProductRecord& record) const
+		{
+			record.type = (bits & perishable_flag) != 0 ? 'P' : 'N';
+			memcpy(record.sku, sku, sizeof(record.sku));
+			record.name = "";
+			record.name_length = 0;
+			memcpy(record.unit, units[(size_t)unit].c_str(), units[(size_t)unit].size() + 1);
+			record.taxed = (bits & taxed_flag) != 0;
+			record.price = price;
+			record.quantity = (int)quantity;
+			record.needed = (int)needed;
+			record.expiry = (bits & dated_flag) != 0 ? keyDate(date) : Date();
+		}
+
+		//returns true once every record has been visited and every column has been read exactly to its end
+		bool finished() const
+		{
+			for (int c = 0; c < column_count; ++c) {
+				if (cursors[c] != ends[c])
+					return false;
+			}
+			return index == count;
+		}
+	};
+
+	//This function writes the store to the named catalog file and returns true on success.
+	bool saveCatalog(const char * filename, const InventoryStore & store)
+	{
+		std::fstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		CatalogHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, catalog_magic, sizeof(header.magic));
+		header.version = catalog_version;
+		header.block_records = catalog_block_records;
+		header.record_count = store.size();
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		/*the fields of every row, gathered in row order (reading the columns of the store sequentially) and then
+		sorted by sku, with each name and unit replaced by its dictionary id*/
+		Dictionary names, units;
+		std::vector<CatalogEntry> entries(store.size());
+		for (size_t row = 0; row < store.size(); ++row) {
+			CatalogEntry& entry = entries[row];
+			const char* name = store.name(row);
+			if (name == nullptr)
+				name = "";
+			entry.key = skuKey(store.sku(row));
+			entry.price = store.price(row);
+			entry.date = dateKey(store.expiry(row));
+			entry.name = names.add(name, strlen(name));
+			entry.unit = (unsigned int)units.add(store.unit(row), strlen(store.unit(row)));
+			entry.quantity = store.quantity(row);
+			entry.needed = store.qtyNeeded(row);
+			entry.bits = store.taxed(row) ? taxed_flag : 0;
+			if (store.type(row) == 'P')
+				entry.bits |= perishable_flag;
+			else if (store.type(row) != 'N')
+				return false;
+		}
+		std::sort(entries.begin(), entries.end(),
+			[](const CatalogEntry& a, const CatalogEntry& b) { return a.key < b.key; });
+
+		std::vector<CatalogBlock> index;
+		std::vector<unsigned char> flags, columns[column_count], raw, packed;
+		unsigned long long offset = sizeof(header);
+
+		//compresses the block in raw (unless that does not make it smaller), writes it and adds it to the index
+		auto emit = [&](unsigned long long first) {
+			if (raw.size() > 0xFFFFFFFFULL)
+				return false;
+			compress(raw.data(), raw.size(), packed);
+			const std::vector<unsigned char>& stored = packed.size() < raw.size() ? packed : raw;
+			CatalogBlock block;
+			block.first = first;
+			block.offset = offset;
+			block.size = (unsigned int)stored.size();
+			block.raw_size = (unsigned int)raw.size();
+			Checksum checksum;
+			checksum.update(stored.data(), stored.size());
+			block.checksum = checksum.value();
+			index.push_back(block);
+			file.write(reinterpret_cast<const char*>(stored.data()), (std::streamsize)stored.size());
+			offset += stored.size();
+			return true;
+		};
+
+		//the record blocks
+		for (size_t first = 0; first < entries.size(); first += catalog_block_records) {
+			size_t last = std::min(entries.size(), first + (size_t)catalog_block_records);
+			flags.assign((last - first + 1) / 2, 0);
+			for (std::vector<unsigned char>& column : columns)
+				column.clear();
+			char previous[max_sku_length + 1] = { 0 };
+			unsigned long long previousDate = 0;
+
+			for (size_t i = first; i < last; ++i) {
+				const CatalogEntry& entry = entries[i];
+				unsigned bits = entry.bits;
+
+				char sku[max_sku_length + 1];
+				size_t length = 0;
+				for (; length < (size_t)max_sku_length; ++length) {
+					sku[length] = (char)(entry.key >> (56 - 8 * length));
+					if (sku[length] == '\0')
+						break;
+				}
+				sku[length] = '\0';
+				size_t shared = 0;
+				while (shared < length && sku[shared] == previous[shared])
+					++shared;
+				columns[sku_column].push_back((unsigned char)(shared << 4 | (length - shared)));
+				columns[sku_column].insert(columns[sku_column].end(), sku + shared, sku + length);
+				memcpy(previous, sku, length + 1);
+
+				put(columns[name_column], entry.name);
+				put(columns[unit_column], entry.unit);
+				put(columns[quantity_column], zigzag(entry.quantity));
+				put(columns[quantity_column], zigzag(entry.needed));
+
+				long long cents;
+				if (priceCents(entry.price, cents)) {
+					bits |= cents_flag;
+					put(columns[price_column], zigzag(cents));
+				}
+				else {
+					unsigned char bytes[sizeof(entry.price)];
+					memcpy(bytes, &entry.price, sizeof(entry.price));
+					columns[price_column].insert(columns[price_column].end(), bytes, bytes + sizeof(bytes));
+				}
+
+				if (entry.date != 0) {
+					bits |= dated_flag;
+					put(columns[date_column], zigzag((long long)(entry.date - previousDate)));
+					previousDate = entry.date;
+				}
+				flags[(i - first) / 2] |= (unsigned char)(bits << ((i - first) % 2 * 4));
+			}
+
+			raw.clear();
+			for (const std::vector<unsigned char>& column : columns)
+				put(raw, column.size());
+			raw.insert(raw.end(), flags.begin(), flags.end());
+			for (const std::vector<unsigned char>& column : columns)
+				raw.insert(raw.end(), column.begin(), column.end());
+			if (!emit(entries[first].key))
+				return false;
+		}
+
+		//the name blocks
+		for (size_t first = 0; first < names.size(); first += catalog_block_records) {
+			size_t last = std::min(names.size(), first + (size_t)catalog_block_records);
+			raw.clear();
+			for (size_t id = first; id < last; ++id)
+				raw.insert(raw.end(), names.at(id), names.at(id) + names.length(id) + 1);
+			if (!emit(0))
+				return false;
+		}
+
+		//the unit section and the block index
+		std::vector<unsigned char> tail;
+		for (size_t id = 0; id < units.size(); ++id) {
+			tail.push_back((unsigned char)units.length(id));
+			tail.insert(tail.end(), units.at(id), units.at(id) + units.length(id));
+		}
+		header.units_offset = offset;
+		header.index_offset = offset + tail.size();
+		const unsigned char* blocks = reinterpret_cast<const unsigned char*>(index.data());
+		tail.insert(tail.end(), blocks, blocks + index.size() * sizeof(CatalogBlock));
+		Checksum checksum;
+		checksum.update(tail.data(), tail.size());
+		file.write(reinterpret_cast<const char*>(tail.data()), (std::streamsize)tail.size());
+
+		header.unit_count = (unsigned int)units.size();
+		header.name_count = names.size();
+		header.checksum = checksum.value();
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.flush();
+		return !file.fail();
+	}
+
+	/*This function replaces the contents of the store with the named catalog file and returns true on success. The
+	whole file is checked before the store is touched.*/
+	bool loadCatalog(const char * filename, InventoryStore & store)
+	{
+		CatalogReader reader;
+		//every block is checked as it is expanded, so the blocks are not verified up front
+		if (!reader.open(filename))
+			return false;
+
+		store.clear();
+		store.reserve(reader.size());
+		bool valid = true;
+		std::vector<const char*> interned;
+		std::vector<size_t> lengths;
+		interned.reserve(reader.name_count);
+		lengths.reserve(reader.name_count);
+		for (size_t id = 0; id < reader.name_count && valid; ++id) {
+			const char* name = reader.name(id);
+			valid = name != nullptr;
+			if (valid) {
+				lengths.push_back(strlen(name));
+				interned.push_back(store.intern(name, lengths.back()));
+			}
+		}
+
+		std::vector<ProductRecord> records;
+		std::vector<unsigned long long> ids;
+		for (size_t block = 0; block < reader.blocks() && valid; ++block) {
+			valid = reader.decode(block, records, ids);
+			for (size_t i = 0; i < records.size() && valid; ++i) {
+				valid = ids[i] < interned.size();
+				if (valid) {
+					records[i].name = interned[(size_t)ids[i]];
+					records[i].name_length = lengths[(size_t)ids[i]];
+					store.appendBorrowed(records[i]);
+				}
+			}
+		}
+		if (!valid) {
+			store.clear();
+			return false;
+		}
+		store.reindex();
+		return true;
+	}
+
+	//This constructor creates a reader with no catalog open.
+	CatalogReader::CatalogReader() : block_records(0), record_count(0), name_count(0), raw_block(npos)
+	{
+	}
+
+	CatalogReader::~CatalogReader()
+	{
+	}
+
+	//This modifier opens the named catalog file and reads its header, unit dictionary and block index.
+	bool CatalogReader::open(const char * filename)
+	{
+		close();
+		std::unique_ptr<MappedFile> mapping(new MappedFile());
+		if (!mapping->open(filename) || mapping->size() < sizeof(CatalogHeader))
+			return false;
+
+		CatalogHeader header;
+		memcpy(&header, mapping->data(), sizeof(header));
+		unsigned long long size = mapping->size();
+		if (memcmp(header.magic, catalog_magic, sizeof(header.magic)) != 0 || header.version != catalog_version ||
+			header.block_records == 0 || header.units_offset < sizeof(header) ||
+			header.units_offset > header.index_offset || header.index_offset > size ||
+			(size - header.index_offset) % sizeof(CatalogBlock) != 0)
+			return false;
+
+		unsigned long long entries = (size - header.index_offset) / sizeof(CatalogBlock);
+		unsigned long long recordBlocks = header.record_count / header.block_records +
+			(header.record_count % header.block_records != 0 ? 1 : 0);
+		unsigned long long nameBlocks = header.name_count / header.block_records +
+			(header.name_count % header.block_records != 0 ? 1 : 0);
+		if (recordBlocks > entries || nameBlocks != entries - recordBlocks)
+			return false;
+
+		const char* base = mapping->data();
+		Checksum checksum;
+		checksum.update(base + header.units_offset, (size_t)(size - header.units_offset));
+		if (checksum.value() != header.checksum)
+			return false;
+
+		//the unit dictionary must fill its section exactly
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(base + header.units_offset);
+		const unsigned char* last = reinterpret_cast<const unsigned char*>(base + header.index_offset);
+		std::vector<std::string> dictionary;
+		dictionary.reserve(std::min<unsigned long long>(header.unit_count, (unsigned long long)(last - p)));
+		for (unsigned int i = 0; i < header.unit_count; ++i) {
+			if (p == last || *p > max_unit_length || *p >= last - p)
+				return false;
+			dictionary.push_back(std::string(reinterpret_cast<const char*>(p + 1), *p));
+			p += 1 + *p;
+		}
+		if (p != last)
+			return false;
+
+		//every block must lie between the header and the unit section, and the record blocks must be in sku order
+		std::vector<CatalogBlock> index((size_t)entries);
+		if (entries != 0)
+			memcpy(index.data(), base + header.index_offset, (size_t)entries * sizeof(CatalogBlock));
+		for (size_t i = 0; i < index.size(); ++i) {
+			const CatalogBlock& block = index[i];
+			if (block.offset < sizeof(header) || block.offset > header.units_offset ||
+				block.size > header.units_offset - block.offset || block.size > block.raw_size ||
+				(i != 0 && i < recordBlocks && block.first < index[i - 1].first))
+				return false;
+		}
+
+		file = std::move(mapping);
+		block_records = header.block_records;
+		record_count = (size_t)header.record_count;
+		name_count = (size_t)header.name_count;
+		record_blocks.assign(index.begin(), index.begin() + (size_t)recordBlocks);
+		name_blocks.assign(index.begin() + (size_t)recordBlocks, index.end());
+		units = std::move(dictionary);
+		names.resize(name_blocks.size());
+		return true;
+	}
+
+	//This modifier closes the catalog and releases every expanded block.
+	void CatalogReader::close()
+	{
+		file.reset();
+		block_records = 0;
+		record_count = 0;
+		name_count = 0;
+		record_blocks.clear();
+		name_blocks.clear();
+		units.clear();
+		names.clear();
+		raw.clear();
+		raw_block = npos;
+	}
+
+	size_t CatalogReader::size() const
+	{
+		return record_count;
+	}
+
+	size_t CatalogReader::blocks() const
+	{
+		return record_blocks.size();
+	}
+
+	//This query checks every block of the open catalog against its checksum.
+	bool CatalogReader::verify() const
+	{
+		for (const std::vector<CatalogBlock>* blocks : { &record_blocks, &name_blocks }) {
+			for (const CatalogBlock& block : *blocks) {
+				Checksum checksum;
+				checksum.update(file->data() + block.offset, block.size);
+				if (checksum.value() != block.checksum)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	//expands a block into the buffer and returns true if it matches its checksum and expands to its full size
+	bool CatalogReader::expand(const CatalogBlock & block, std::vector<unsigned char>& buffer) const
+	{
+		const unsigned char* stored = reinterpret_cast<const unsigned char*>(file->data() + block.offset);
+		Checksum checksum;
+		checksum.update(stored, block.size);
+		if (checksum.value() != block.checksum)
+			return false;
+		buffer.resize(block.raw_size);
+		if (block.size == block.raw_size) {
+			if (block.size != 0)
+				memcpy(buffer.data(), stored, block.size);
+			return true;
+		}
+		return uncompress(stored, stored + block.size, buffer.data(), buffer.size());
+	}
+
+	//returns the name with the given id, expanding its name block if needed
+	const char * CatalogReader::name(unsigned long long id)
+	{
+		if (id >= name_count)
+			return nullptr;
+		size_t block = (size_t)(id / block_records);
+		Names& expanded = names[block];
+		if (expanded.starts.empty()) {
+			std::vector<unsigned char> buffer;
+			if (!expand(name_blocks[block], buffer))
+				return nullptr;
+			size_t count = std::min(block_records, name_count - block * block_records);
+			std::vector<unsigned int> starts;
+			starts.reserve(count);
+			size_t start = 0;
+			for (size_t i = 0; i < buffer.size(); ++i) {
+				if (buffer[i] == '\0') {
+					starts.push_back((unsigned int)start);
+					start = i + 1;
+				}
+			}
+			if (starts.size() != count || start != buffer.size())
+				return nullptr;
+			expanded.text.assign(buffer.begin(), buffer.end());
+			expanded.starts = std::move(starts);
+		}
+		return expanded.text.data() + expanded.starts[(size_t)(id % block_records)];
+	}
+
+	//expands a record block into raw, unless it is the block already there, and returns false if it cannot be read
+	bool CatalogReader::load(size_t block)
+	{
+		if (block == raw_block)
+			return true;
+		raw_block = npos;
+		if (block >= record_blocks.size() || !expand(record_blocks[block], raw))
+			return false;
+		raw_block = block;
+		return true;
+	}
+
+	//expands and decodes the records of a record block, storing the name id of each in ids
+	bool CatalogReader::decode(size_t block, std::vector<ProductRecord>& records, std::vector<unsigned long long>& ids)
+	{
+		records.clear();
+		ids.clear();
+		if (!load(block))
+			return false;
+		size_t count = std::min(block_records, record_count - block * block_records);
+		BlockCursor cursor(units);
+		if (!cursor.start(raw, count))
+			return false;
+		records.resize(count);
+		ids.resize(count);
+		for (size_t i = 0; i < count; ++i) {
+			if (!cursor.next())
+				return false;
+			cursor.copy(records[i]);
+			ids[i] = cursor.name;
+		}
+		return cursor.finished();
+	}
+
+	//This modifier looks up the product with the given sku and copies it into the record.
+	bool CatalogReader::find(const char * sku, ProductRecord & record)
+	{
+		if (!file)
+			return false;
+		unsigned long long key = skuKey(sku);
+		std::vector<CatalogBlock>::const_iterator after = std::upper_bound(record_blocks.begin(), record_blocks.end(),
+			key, [](unsigned long long k, const CatalogBlock& block) { return k < block.first; });
+		if (after == record_blocks.begin())
+			return false;
+		size_t block = (size_t)(after - record_blocks.begin()) - 1;
+		if (!load(block))
+			return false;
+
+		//the skus of a block are in order, so the walk stops at the first sku that is not below the one sought
+		BlockCursor cursor(units);
+		if (!cursor.start(raw, std::min(block_records, record_count - block * block_records)))
+			return false;
+		if (!cursor.seek(key) || skuKey(cursor.sku) != key)
+			return false;
+		const char* text = name(cursor.name);
+		if (text == nullptr)
+			return false;
+		cursor.copy(record);
+		record.name = text;
+		record.name_length = strlen(text);
+		return true;
+	}
+
+	//This modifier decodes every product of the given record block into the vector.
+	bool CatalogReader::read(size_t block, std::vector<ProductRecord>& records)
+	{
+		std::vector<unsigned long long> ids;
+		if (!file || !decode(block, records, ids))
+			return false;
+		for (size_t i = 0; i < records.size(); ++i) {
+			records[i].name = name(ids[i]);
+			if (records[i].name == nullptr)
+				return false;
+			records[i].name_length = strlen(records[i].name);
+		}
+		return true;
+	}
+}
@@ -0,0 +1,146 @@
+//Compressed catalog files of an InventoryStore: a fraction of the size of the text product file or of a snapshot,
+//with a block index for looking up single products without reading the whole file.
+
+#ifndef GMS_Catalog_H
+#define GMS_Catalog_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "InventoryStore.h"
+#include "ProductRecord.h"
+#include "MappedFile.h"
+
+namespace GMS {
+
+	//the version written by saveCatalog; loadCatalog and CatalogReader reject any other version
+	const unsigned catalog_version = 1;
+
+	//the number of records in a record block, and of names in a name block, written by saveCatalog
+	const unsigned catalog_block_records = 1024;
+
+	/*A catalog file holds the products in sku order (strcmp order of the skus), in this order:
+
+		a 64-byte header: the magic "GMSC", the format version, the number of records per block, the number of units,
+		  records and names, the offsets of the unit section and of the block index, and a 64-bit checksum of both
+		the record blocks: catalog_block_records products each
+		the name blocks: the name dictionary, that is every distinct name once, catalog_block_records names each, in
+		  the row order of their first use in the saved store
+		the unit section: the unit dictionary, every distinct unit once (a length byte and the characters)
+		the block index: for every record block and then every name block, its offset and stored size, its size once
+		  expanded, a checksum of its stored bytes and, for a record block, the sku of its first record packed
+		  big-endian into 64 bits, so that the block holding a sku is found by a binary search of the index
+
+	A record block is column-oriented. It starts with the sizes of its variable-width columns, followed by
+
+		the flags: four bits per record (perishable, taxable, price in cents, dated), two records to a byte
+		the skus, front-coded: a byte holding the length of the prefix shared with the previous sku and the length of
+		  the rest, followed by the rest
+		the name and unit ids, as varints into the dictionaries
+		the quantities on hand and needed, as zigzag varints
+		the prices: those that are a whole number of cents once multiplied by 100 (and divide back to exactly the same
+		  double) as a zigzag varint of the cents, any other as the 8 bytes of the double
+		the expiry dates of the dated records, as zigzag varints of the difference from the previous dated record of
+		  the block
+
+	Every block (names or records) is then compressed on its own with a byte-oriented LZ77 coding, or stored as is
+	when that does not make it smaller, so that reading a product only expands the blocks that hold it. The varints
+	are byte order independent, but the header, the block index and the prices stored as doubles are written in the
+	native byte order of the machine (little-endian on every supported target), so a catalog is only read back on a
+	machine of the same byte order. As with a snapshot, prices survive bit for bit, but the products of a loaded catalog
+	are in sku order rather than in the row order of the saved store.*/
+
+	/*This function writes the store to the named catalog file and returns true on success. It fails if a product
+	is neither regular ('N') nor perishable ('P').*/
+	bool saveCatalog(const char* filename, const InventoryStore& store);
+
+	/*This function replaces the contents of the store with the named catalog file and returns true on success. Every
+	distinct name is copied into the store once and the indexes are built in a single pass once every record has
+	been appended. Each block is checked against its checksum as it is expanded, so the file is read only once. If the
+	file cannot be read, is not a catalog of a supported version, or its unit dictionary or block index fail their
+	checksum, the function returns false and leaves the store unchanged; if a block fails its checksum or does not
+	decode, the function returns false and leaves the store empty.*/
+	bool loadCatalog(const char* filename, InventoryStore& store);
+
+	//an entry of the block index of a catalog file, exactly as stored in the file
+	struct CatalogBlock {
+		unsigned long long first;
+		unsigned long long offset;
+		unsigned int size;
+		unsigned int raw_size;
+		unsigned long long checksum;
+	};
+
+	/*A CatalogReader looks up single products in a catalog file without loading it. Opening a catalog maps the file
+	and reads its header, unit dictionary and block index only; a lookup expands the one record block that can hold
+	the sku, walks its skus up to the one sought (skipping the other fields of the records before it) and expands the
+	name block that holds its name. The most recently expanded record block and every expanded name block are kept,
+	so lookups of nearby skus touch no more of the file.*/
+	class CatalogReader {
+
+		//an expanded name block: the null-terminated names and the offset of each
+		struct Names {
+			std::vector<char> text;
+			std::vector<unsigned int> starts;
+		};
+
+		std::unique_ptr<MappedFile> file;
+		size_t block_records;
+		size_t record_count;
+		size_t name_count;
+		std::vector<CatalogBlock> record_blocks;
+		std::vector<CatalogBlock> name_blocks;
+		std::vector<std::string> units;
+		std::vector<Names> names;
+		//the most recently expanded record block and its number (npos if none)
+		std::vector<unsigned char> raw;
+		size_t raw_block;
+
+		//expands a block into the buffer and returns true if it matches its checksum and expands to its full size
+		bool expand(const CatalogBlock& block, std::vector<unsigned char>& buffer) const;
+		//returns the name with the given id, expanding its name block if needed, or nullptr if it cannot be read
+		const char* name(unsigned long long id);
+		//expands a record block into raw, unless it is the block already there, and returns false if it cannot be read
+		bool load(size_t block);
+		//expands and decodes the records of a record block, storing the name id of each in ids
+		bool decode(size_t block, std::vector<ProductRecord>& records, std::vector<unsigned long long>& ids);
+
+		friend bool loadCatalog(const char* filename, InventoryStore& store);
+
+	public:
+
+		//the value of raw_block when no record block is expanded
+		static const size_t npos = static_cast<size_t>(-1);
+
+		//This constructor creates a reader with no catalog open.
+		CatalogReader();
+		CatalogReader(const CatalogReader&) = delete;
+		CatalogReader& operator=(const CatalogReader&) = delete;
+		~CatalogReader();
+
+		/*This modifier opens the named catalog file, closing any catalog already open, and returns true on success. It
+		returns false if the file cannot be read or if its header, unit dictionary or block index are not valid.*/
+		bool open(const char* filename);
+
+		//This modifier closes the catalog and releases every expanded block.
+		void close();
+
+		//These queries return the number of products and of record blocks of the open catalog.
+		size_t size() const;
+		size_t blocks() const;
+
+		/*This query checks every block of the open catalog against its checksum, reading the whole file, and returns
+		true if they all match.*/
+		bool verify() const;
+
+		/*This modifier looks up the product with the given sku and copies it into the record. It returns false if
+		there is no such product or if its blocks cannot be read. The name of the record is null-terminated and stays
+		valid until the reader is closed.*/
+		bool find(const char* sku, ProductRecord& record);
+
+		/*This modifier decodes every product of the given record block (in sku order) into the vector and returns
+		true on success. The names stay valid until the reader is closed.*/
+		bool read(size_t block, std::vector<ProductRecord>& records);
+	};
+}
+#endif // !GMS_Catalog_H
@@ -0,0 +1,71 @@
+//The Checksum class computes the 64-bit checksums that guard the binary store files (snapshots and catalogs).
+
+#ifndef GMS_Checksum_H
+#define GMS_Checksum_H
+
+#include <cstring>
+
+namespace GMS {
+
+	/*A 64-bit checksum that consumes eight bytes at a time in four independent lanes, so that checking a file
+	runs at close to memory speed.*/
+	class Checksum {
+
+		unsigned long long lanes[4];
+		unsigned long long words;
+		unsigned long long tail;
+		unsigned tail_bytes;
+
+		static unsigned long long rotate(unsigned long long x, int r)
+		{
+			return (x << r) | (x >> (64 - r));
+		}
+
+		void word(unsigned long long w)
+		{
+			unsigned long long& lane = lanes[words++ & 3];
+			lane = rotate(lane ^ (w * 0x9E3779B97F4A7C15ULL), 29) * 0xBF58476D1CE4E5B9ULL;
+		}
+
+	public:
+
+		Checksum() : words(0), tail(0), tail_bytes(0)
+		{
+			lanes[0] = 0x243F6A8885A308D3ULL;
+			lanes[1] = 0x13198A2E03707344ULL;
+			lanes[2] = 0xA4093822299F31D0ULL;
+			lanes[3] = 0x082EFA98EC4E6C89ULL;
+		}
+
+		void update(const void* data, size_t length)
+		{
+			const unsigned char* p = static_cast<const unsigned char*>(data);
+			while (length != 0 && tail_bytes != 0) {
+				tail |= (unsigned long long)*p++ << (8 * tail_bytes);
+				--length;
+				if (++tail_bytes == 8) {
+					word(tail);
+					tail = 0;
+					tail_bytes = 0;
+				}
+			}
+			for (; length >= 8; p += 8, length -= 8) {
+				unsigned long long w;
+				memcpy(&w, p, 8);
+				word(w);
+			}
+			for (; length != 0; --length)
+				tail |= (unsigned long long)*p++ << (8 * tail_bytes++);
+		}
+
+		unsigned long long value() const
+		{
+			unsigned long long h = words * 8 + tail_bytes;
+			for (int i = 0; i < 4; ++i)
+				h = rotate(h ^ lanes[i], 27) * 0x94D049BB133111EBULL;
+			h = rotate(h ^ tail, 31) * 0x9E3779B97F4A7C15ULL;
+			return h ^ (h >> 32);
+		}
+	};
+}
+#endif // !GMS_Checksum_H
@@ -0,0 +1,142 @@
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#include "ConcurrentStock.h"
+
+namespace GMS {
+
+	/*The quantity columns are plain ints, so they are accessed through the atomic operations of the compiler rather
+	than std::atomic<int> (which would change the element type of the columns that the batch valuation loads
+	directly). On Windows a long has the size of an int.*/
+#ifdef _MSC_VER
+	static int fetchAdd(int* p, int value)
+	{
+		return (int)_InterlockedExchangeAdd(reinterpret_cast<volatile long*>(p), (long)value);
+	}
+
+	static bool compareExchange(int* p, int& expected, int desired)
+	{
+		long previous = _InterlockedCompareExchange(reinterpret_cast<volatile long*>(p), (long)desired, (long)expected);
+		bool exchanged = previous == (long)expected;
+		expected = (int)previous;
+		return exchanged;
+	}
+
+	static void store(int* p, int value)
+	{
+		_InterlockedExchange(reinterpret_cast<volatile long*>(p), (long)value);
+	}
+
+	static int load(const int* p)
+	{
+		return *reinterpret_cast<const volatile int*>(p);
+	}
+#else
+	static int fetchAdd(int* p, int value)
+	{
+		return __atomic_fetch_add(p, value, __ATOMIC_RELAXED);
+	}
+
+	static bool compareExchange(int* p, int& expected, int desired)
+	{
+		return __atomic_compare_exchange_n(p, &expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+	}
+
+	static void store(int* p, int value)
+	{
+		__atomic_store_n(p, value, __ATOMIC_RELAXED);
+	}
+
+	static int load(const int* p)
+	{
+		return __atomic_load_n(p, __ATOMIC_RELAXED);
+	}
+#endif
+
+	//This constructor creates the concurrent stock of the referenced store, with no row isolated.
+	ConcurrentStock::ConcurrentStock(InventoryStore & store) : inventory(store)
+	{
+	}
+
+	//The destructor settles the isolated rows, if any.
+	ConcurrentStock::~ConcurrentStock()
+	{
+		settle();
+	}
+
+	//returns the address of the quantity on hand of the row: its HotQuantity if it is isolated, its column element if not
+	int * ConcurrentStock::onHand(size_t row) const
+	{
+		if (!hot_slots.empty() && hot_slots[row] != 0)
+			return &hot[hot_slots[row] - 1].quantity;
+		return &inventory.quantities_on_hand[row];
+	}
+
+	//This modifier isolates the given rows, ignoring repeated rows and rows that are not in the store.
+	void ConcurrentStock::isolate(const std::vector<size_t>& rows)
+	{
+		settle();
+		if (rows.empty())
+			return;
+		hot.reset(new HotQuantity[rows.size()]);
+		hot_slots.assign(inventory.size(), 0);
+		unsigned int count = 0;
+		for (size_t row : rows) {
+			if (row < hot_slots.size() && hot_slots[row] == 0) {
+				hot[count].quantity = inventory.quantities_on_hand[row];
+				hot_slots[row] = ++count;
+			}
+		}
+	}
+
+	void ConcurrentStock::settle()
+	{
+		for (size_t row = 0; row < hot_slots.size(); row++)
+			if (hot_slots[row] != 0)
+				inventory.quantities_on_hand[row] = hot[hot_slots[row] - 1].quantity;
+		hot_slots.clear();
+		hot.reset();
+	}
+
+	size_t ConcurrentStock::find(const char * sku) const
+	{
+		return inventory.find(sku);
+	}
+
+	int ConcurrentStock::receive(size_t row, int units)
+	{
+		int* quantity = onHand(row);
+		if (units > 0)
+			return fetchAdd(quantity, units) + units;
+		return load(quantity);
+	}
+
+	//This modifier removes up to the given number of units, retrying if another thread changed the quantity meanwhile.
+	int ConcurrentStock::sell(size_t row, int units)
+	{
+		int* quantity = onHand(row);
+		int current = load(quantity);
+		int taken;
+		do {
+			taken = units < current ? units : current;
+			if (taken <= 0)
+				return 0;
+		} while (!compareExchange(quantity, current, current - taken));
+		return taken;
+	}
+
+	void ConcurrentStock::quantity(size_t row, int qtyOnHand)
+	{
+		store(onHand(row), qtyOnHand);
+	}
+
+	int ConcurrentStock::quantity(size_t row) const
+	{
+		return load(onHand(row));
+	}
+
+	int ConcurrentStock::qtyNeeded(size_t row) const
+	{
+		return load(&inventory.quantities_needed[row]);
+	}
+}
@@ -0,0 +1,84 @@
+//The ConcurrentStock class lets many threads update and read the quantities of the products of an InventoryStore at
+//the same time.
+
+#ifndef GMS_ConcurrentStock_H
+#define GMS_ConcurrentStock_H
+
+#include <memory>
+#include <vector>
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	/*A ConcurrentStock works on the quantity columns of an InventoryStore in place. Every function below may be called
+	from any number of threads at once, without any lock: each quantity is updated with a single atomic operation on
+	its own element of the column (a compare-and-swap loop for sell), so threads only ever wait for each other when
+	they update the very same product, and then only for the duration of one instruction.
+
+	The structure of the store must not change while threads use the stock: rows can only be inserted, erased,
+	reassigned or re-keyed (and the store cleared) while no thread is calling these functions. The sku index is only
+	read, so find is safe. The other column queries of the store (InventoryStore::total_cost, valueInventory, ...) do
+	not synchronize with the updates and must not run at the same time either. The updates do not maintain the reorder
+	set or the running totals of the store: call InventoryStore::resync once the threads are done (and the isolated
+	rows, if any, settled), before querying them.
+
+	Neighbouring rows share a cache line (16 quantities to a 64-byte line), so threads updating different products
+	that happen to be close in the column still take the line from each other. The quantities of the products that
+	are known to be hot can be isolated, each on a cache line of its own, for as long as the threads run; they are
+	written back to the store when settled.*/
+	class ConcurrentStock {
+
+		//the quantity on hand of an isolated row, alone on its cache line
+		struct alignas(64) HotQuantity {
+			int quantity;
+		};
+
+		InventoryStore& inventory;
+		std::unique_ptr<HotQuantity[]> hot;
+		//for every row of the store, one more than the index of its HotQuantity, or 0 if it is not isolated; empty
+		//if no row is
+		std::vector<unsigned int> hot_slots;
+
+		//returns the address of the quantity on hand of the row
+		int* onHand(size_t row) const;
+
+	public:
+
+		//This constructor creates the concurrent stock of the referenced store, with no row isolated.
+		explicit ConcurrentStock(InventoryStore& store);
+		ConcurrentStock(const ConcurrentStock&) = delete;
+		ConcurrentStock& operator=(const ConcurrentStock&) = delete;
+
+		//The destructor settles the isolated rows, if any.
+		~ConcurrentStock();
+
+		/*This modifier settles the rows already isolated, if any, and moves the quantity on hand of each of the given
+		rows to a cache line of its own. Until they are settled, the quantity column of the store does not follow the
+		updates of these rows. Like a change to the structure of the store, it must not be called while threads use
+		the stock.*/
+		void isolate(const std::vector<size_t>& rows);
+
+		/*This modifier writes the quantities of the isolated rows back to the store and ends their isolation. It must
+		not be called while threads use the stock.*/
+		void settle();
+
+		//This query returns the row of the product with the given sku, or InventoryStore::npos if there is none.
+		size_t find(const char* sku) const;
+
+		/*This modifier adds a positive number of units to the quantity on hand of the row and returns the updated
+		quantity, like Product::operator+=. A number of units that is not positive changes nothing.*/
+		int receive(size_t row, int units);
+
+		/*This modifier removes up to the given number of units from the quantity on hand of the row, never taking it
+		below zero, and returns the number of units actually removed.*/
+		int sell(size_t row, int units);
+
+		//This modifier sets the quantity on hand of the row, like Product::quantity(int).
+		void quantity(size_t row, int qtyOnHand);
+
+		//These queries return the quantity on hand and the quantity needed of the row.
+		int quantity(size_t row) const;
+		int qtyNeeded(size_t row) const;
+	};
+}
+#endif // !GMS_ConcurrentStock_H
@@ -4,6 +4,60 @@
 
 namespace GMS {
 
+  //the white space characters skipped by operator>>
+  static bool isSpace(int c)
+  {
+	  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+  }
+
+  static const char* skipSpace(const char* first, const char* last)
+  {
+	  while (first != last && isSpace((unsigned char)*first))
+		  ++first;
+	  return first;
+  }
+
+  //parses an optionally signed decimal integer at first; returns the address after it, or nullptr if there are no
+  //digits or the number does not fit an int
+  static const char* parseNumber(const char* first, const char* last, int& value)
+  {
+	  bool negative = false;
+	  if (first != last && (*first == '-' || *first == '+')) {
+		  negative = *first == '-';
+		  ++first;
+	  }
+	  if (first == last || *first < '0' || *first > '9')
+		  return nullptr;
+	  long long result = 0;
+	  for (; first != last && *first >= '0' && *first <= '9'; ++first) {
+		  result = result * 10 + (*first - '0');
+		  if (result > 2147483648LL)
+			  return nullptr;
+	  }
+	  result = negative ? -result : result;
+	  if (result > 2147483647LL)
+		  return nullptr;
+	  value = (int)result;
+	  return first;
+  }
+
+  //writes an integer in decimal and returns the address after its last digit
+  static char* formatNumber(char* buffer, int value)
+  {
+	  unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+	  char digits[10];
+	  int count = 0;
+	  do {
+		  digits[count++] = (char)('0' + magnitude % 10);
+		  magnitude /= 10;
+	  } while (magnitude != 0);
+	  if (value < 0)
+		  *buffer++ = '-';
+	  while (count != 0)
+		  *buffer++ = digits[--count];
+	  return buffer;
+  }
+
   // number of days in month mon_ and year year_
   int Date::mdays(int mon, int year)const {
     int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31, -1 };
@@ -37,12 +91,12 @@ namespace GMS {
   //3arg constructor
   Date::Date(int year_, int month_, int days_)
   {
-	  if(min_year <= year_ && year_ <= max_year && month_ > 0 && month < 13 && days_ > 0 && days_ <= mdays(month_, year_))
+	  if(min_year <= year_ && year_ <= max_year && month_ > 0 && month_ < 13 && days_ > 0 && days_ <= mdays(month_, year_))
 	  {
 		  year = year_;
 		  month = month_;
 		  days = days_;
-		  comparator = year * 372 + month * 13 + days;
+		  comparator = year * 372 + month * 31 + days;
 		  errorState = NO_ERROR;
 	  }
 	  else {
@@ -122,6 +176,19 @@ namespace GMS {
 		  return false;
   }
 
+  //this query stores the year, month and day of the date in its parameters (all zero for an empty date)
+  void Date::extract(int& year_, int& month_, int& days_) const
+  {
+	  year_ = year;
+	  month_ = month;
+	  days_ = days;
+  }
+
+  int Date::key() const
+  {
+	  return comparator;
+  }
+
   //reads the date from console, in the format y/m/d, this f. does not promt user. 
   //If istr fails at any point (if istr fails, the function istr.fail() returns true), this function sets
   //the error state to CIN_FAILED and does not clear istr. If read() reads the number successfully, and the 
@@ -129,65 +196,117 @@ namespace GMS {
   //the current object. Returns the reference to the std::istream object
   std::istream & Date::read(std::istream & istr)
   {
-	  char data;
-	  int tempError = 0;
+	  //copy the characters of the three numbers and the two separators straight from the stream buffer, exactly as
+	  //many as operator>> would extract, then parse them
+	  const int eof = std::char_traits<char>::eof();
+	  std::streambuf* buffer = istr.rdbuf();
+	  char text[64];
+	  int length = 0;
 	  istr.clear();
-	  istr >> year >> data >> month >> data >> days;
-	  if (istr.fail()) {
-		  tempError = CIN_FAILED;
+	  int c = buffer != nullptr ? buffer->sgetc() : eof;
+	  for (int i = 0; i < 3 && c != eof; ++i) {
+		  if (i > 0) {
+			  while (c != eof && isSpace(c))
+				  c = buffer->snextc();
+			  if (c == eof)
+				  break;
+			  text[length++] = (char)c;
+			  c = buffer->snextc();
+		  }
+		  while (c != eof && isSpace(c))
+			  c = buffer->snextc();
+		  int start = length;
+		  if (c == '-' || c == '+') {
+			  text[length++] = (char)c;
+			  c = buffer->snextc();
+		  }
+		  //a number this long fails to parse anyway; the bound leaves room for the separators and signs
+		  while (c >= '0' && c <= '9' && length < 48) {
+			  text[length++] = (char)c;
+			  c = buffer->snextc();
+		  }
+		  //like operator>>, stop at the first number that cannot be extracted
+		  int number;
+		  if (parseNumber(text + start, text + length, number) != text + length)
+			  break;
+	  }
+	  if (c == eof)
+		  istr.setstate(std::ios::eofbit);
+
+	  if (parse(text, text + length) != text + length) {
 		  errorState = CIN_FAILED;
+		  istr.setstate(std::ios::failbit);
 	  }
-	  else if (year < min_year || year > max_year) {
+	  else if (errorState == NO_ERROR) {
+		  istr.clear();
+	  }
+	  return istr;
+  }
+
+  //parses a date in the format y/m/d from the characters [first, last), without a stream
+  const char * Date::parse(const char * first, const char * last)
+  {
+	  int part[3];
+	  const char* p = first;
+	  for (int i = 0; i < 3; ++i) {
+		  if (i > 0) {
+			  p = skipSpace(p, last);
+			  if (p == last) {
+				  errorState = CIN_FAILED;
+				  return nullptr;
+			  }
+			  ++p;
+		  }
+		  p = parseNumber(skipSpace(p, last), last, part[i]);
+		  if (p == nullptr) {
+			  errorState = CIN_FAILED;
+			  return nullptr;
+		  }
+	  }
+
+	  if (part[0] < min_year || part[0] > max_year) {
 		  *this = Date();
-		  tempError =YEAR_ERROR;
-		  errorState =YEAR_ERROR;
+		  errorState = YEAR_ERROR;
 	  }
-	  else if (1 > month || month > 12) {
+	  else if (1 > part[1] || part[1] > 12) {
 		  *this = Date();
-		  tempError = MON_ERROR;
 		  errorState = MON_ERROR;
 	  }
-	  else if (days < 1 || days > mdays(month, year)) {
+	  else if (part[2] < 1 || part[2] > mdays(part[1], part[0])) {
 		  *this = Date();
-		  tempError = DAY_ERROR;
 		  errorState = DAY_ERROR;
 	  }
 	  else {
-		  istr.clear();
-		  Date date(year, month, days);
-		  date.errCode(tempError);
-		  *this = date;
+		  *this = Date(part[0], part[1], part[2]);
 	  }
-	  return istr;
+	  return p;
   }
 
   //this query writes the date to an std::ostream object in the format and then returns a reference to the 
   //std::ostream object.
   std::ostream & Date::write(std::ostream & ostr) const
   {
-	  ostr << year << "/";
-	  if (month < 10)
-	  {
-		  ostr << "0" << month << "/";
-		  if (days < 10) {
-			  ostr << "0" << days;
-		  }
-		  else {
-			  ostr << days;
-		  }
-	  }
-	  else {
-		  ostr << month << "/";
-		  if (days < 10) {
-			  ostr << "0" << days;
-		  }
-		  else {
-			  ostr << days;
-		  }
-	  }
+	  char text[max_date_length + 1];
+	  ostr.write(text, format(text));
 	  return ostr; 
   }
 
+  //this query writes the date into the buffer: the year, then the month and the day with a leading zero below 10
+  int Date::format(char * buffer) const
+  {
+	  char* p = formatNumber(buffer, year);
+	  *p++ = '/';
+	  if (month < 10)
+		  *p++ = '0';
+	  p = formatNumber(p, month);
+	  *p++ = '/';
+	  if (days < 10)
+		  *p++ = '0';
+	  p = formatNumber(p, days);
+	  *p = '\0';
+	  return (int)(p - buffer);
+  }
+
   //helper functions 
   std::istream & operator>>(std::istream & istr, Date & date)
   {
@@ -14,6 +14,8 @@ namespace GMS {
 	//predefined constraints on the years to be considered acceptable
 	const int min_year = 2000;
 	const int max_year = 2030;
+	//the longest text Date::format can produce, excluding the null byte
+	const int max_date_length = 37;
 
   class Date {
 
@@ -58,6 +60,11 @@ namespace GMS {
 	  int errCode() const;
 	  //this query returns true if the error state is not NO_ERROR
 	  bool bad() const;
+	  //this query stores the year, month and day of the date in its parameters (all zero for an empty date)
+	  void extract(int& year_, int& month_, int& days_) const;
+	  //this query returns the value used to compare the date with other dates (zero for an empty date): a later
+	  //date always has a greater value
+	  int key() const;
 
 	  //reads the date from console, in the format y/m/d, this f. does not promt user. 
 	  //If istr fails at any point (if istr fails, the function istr.fail() returns true), this function sets
@@ -66,9 +73,19 @@ namespace GMS {
 	  //the current object. Returns the reference to the std::istream object
 	  std::istream& read(std::istream& istr);
 
+	  //parses a date in the format y/m/d from the characters [first, last), without a stream. The numbers and the
+	  //separators are matched as read() extracts them (white space before each one is skipped, any character
+	  //separates the numbers), and the error state is set to the same codes. Returns the address of the first
+	  //character after the date, or nullptr if no date could be extracted (CIN_FAILED: the date is not changed).
+	  const char* parse(const char* first, const char* last);
+
 	  //this query writes the date to an std::ostream object in the format and then returns a reference to the 
 	  //std::ostream object.
 	  std::ostream& write(std::ostream& ostr)const;
+
+	  //this query writes the date as write() does, into a buffer of at least max_date_length + 1 characters, followed
+	  //by a null byte, and returns the number of characters written before the null byte.
+	  int format(char* buffer) const;
   };
 
   //helper functions 
@@ -14,12 +14,7 @@ namespace GMS {
 	ErrorState::ErrorState(const char * erM)
 	{
 		errorMessage = nullptr;
-
-		if (erM == nullptr)
-			message('\0');
-		else {
-			message(erM);
-		}
+		message(erM);
 	}
 
 	/*	This function de-allocates any memory that has been dynamically allocated by the current object.*/
@@ -29,6 +24,26 @@ namespace GMS {
 		errorMessage = nullptr;
 	}
 
+	/*Move Constructor
+	This function takes over the message of em, if any, and leaves em in a safe empty state.*/
+	ErrorState::ErrorState(ErrorState&& em) noexcept
+	{
+		errorMessage = em.errorMessage;
+		em.errorMessage = nullptr;
+	}
+
+	/*Move Assignment Operator
+	This function releases the current message and takes over the message of em, leaving em in a safe empty state.*/
+	ErrorState& ErrorState::operator=(ErrorState&& em) noexcept
+	{
+		if (this != &em) {
+			delete[] errorMessage;
+			errorMessage = em.errorMessage;
+			em.errorMessage = nullptr;
+		}
+		return *this;
+	}
+
 	/*This function clears any message stored by the current object and initializes the object to a safe empty state.*/
 	void ErrorState::clear()
 	{
@@ -39,41 +54,32 @@ namespace GMS {
 	/*This query reports returns true if the current object is in a safe empty state.*/
 	bool ErrorState::isClear() const
 	{
-		return errorMessage[0] == '\0';
+		return errorMessage == nullptr || errorMessage[0] == '\0';
 	}
 
 	/*This function stores a copy of the C-style string pointed to by str:
 	de-allocates any memory allocated for a previously stored message
 	allocates the dynamic memory needed to store a copy of str (remember to include 1 extra byte for the null terminator)
-	copies the string at address str to the allocated memory.*/
+	copies the string at address str to the allocated memory.
+	An empty message (or nullptr) clears the object instead, so that an error-free object never holds dynamic memory.*/
 	void ErrorState::message(const char * str)
 	{
-		if (str != nullptr) {
-			if (errorMessage != nullptr) {
-				errorMessage[0] = '\0';
-				delete[] errorMessage;
-				errorMessage = nullptr;
-			}
-			errorMessage = new char[strlen(str) + 1];
-			strncpy(errorMessage, str, strlen(str));
-			if (errorMessage[strlen(str)] != '\0') errorMessage[strlen(str)] = '\0';
+		if (str != nullptr && str[0] != '\0') {
+			size_t len = strlen(str);
+			char* copy = new char[len + 1];
+			memcpy(copy, str, len + 1);
+			delete[] errorMessage;
+			errorMessage = copy;
 		}
 		else {
-			errorMessage = new char[1];
-			errorMessage[0] = '\0';
+			clear();
 		}
-		
-		/*ErrorState::~ErrorState();
-		errorMessage = new char[strlen(str) + 1];
-		strncpy(errorMessage, str, strlen(str)+1);
-		errorMessage[strlen(str)] = '\0';
-		*/
 	}
 
-	/*	This query returns the address of the message stored in the current object.*/
+	/*	This query returns the address of the message stored in the current object (an empty string if the object is clear).*/
 	const char * ErrorState::message() const
 	{
-		return errorMessage;
+		return errorMessage != nullptr ? errorMessage : "";
 	}
 
 	/*Helper operator
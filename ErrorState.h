@@ -11,6 +11,8 @@ namespace GMS {
 		explicit ErrorState(const char* erM = nullptr);
 		ErrorState(const ErrorState& em) = delete;
 		ErrorState& operator=(const ErrorState& em) = delete;
+		ErrorState(ErrorState&& em) noexcept;
+		ErrorState& operator=(ErrorState&& em) noexcept;
 		virtual ~ErrorState();
 		void clear();
 		bool isClear() const;
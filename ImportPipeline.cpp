@@ -0,0 +1,323 @@
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include "ImportPipeline.h"
+#include "ProductRecord.h"
+
+namespace GMS {
+
+	//the blocks in flight per parser thread, plus those held by the reader and the inserter
+	static const unsigned blocks_per_parser = 2;
+	static const unsigned blocks_outside_parsers = 2;
+
+	double StageStats::throughput() const
+	{
+		return busy > 0.0 ? (double)bytes / busy : 0.0;
+	}
+
+	//returns the seconds elapsed since start
+	static double secondsSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	//A BoundedQueue passes items between threads in FIFO order, holding at most a fixed number of them.
+	template <typename T>
+	class BoundedQueue {
+
+		std::deque<T> items;
+		size_t capacity;
+		bool closed;
+		std::mutex lock;
+		std::condition_variable changed;
+
+	public:
+
+		explicit BoundedQueue(size_t capacity_) : capacity(capacity_), closed(false)
+		{
+		}
+
+		//waits until the queue has room and appends the item
+		void push(T item)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			changed.wait(guard, [this] { return items.size() < capacity; });
+			items.push_back(item);
+			changed.notify_all();
+		}
+
+		//waits for an item and removes it into item; returns false once the queue is closed and empty
+		bool pop(T& item)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			changed.wait(guard, [this] { return !items.empty() || closed; });
+			if (items.empty())
+				return false;
+			item = items.front();
+			items.pop_front();
+			changed.notify_all();
+			return true;
+		}
+
+		//marks the end of the items: pop returns false once the queue is empty
+		void close()
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			closed = true;
+			changed.notify_all();
+		}
+	};
+
+	//A block of the file: complete lines only, numbered in file order, with the records parsed out of it.
+	struct ImportBlock {
+		size_t sequence;
+		std::vector<char> data;
+		size_t size;
+		std::vector<ProductRecord> records;
+		size_t rejected;
+	};
+
+	/*An ImportPipeline runs the reader and the parsers on their own threads; the thread that calls insert is the
+	inserter. The blocks circulate from the free queue to the reader, then through the filled queue to a parser, and
+	through the parsed queue to the inserter, which hands them back to the free queue once their records are in.*/
+	class ImportPipeline {
+
+		FILE* file;
+		std::vector<ImportBlock> pool;
+		BoundedQueue<ImportBlock*> free;
+		BoundedQueue<ImportBlock*> filled;
+		BoundedQueue<ImportBlock*> parsed;
+		std::thread reader;
+		std::vector<std::thread> parsers;
+		std::atomic<unsigned> running;
+		bool failed;
+		std::mutex lock;
+		PipelineStats counts;
+
+		//reads the file into blocks that end on a line boundary, carrying a partial last line over to the next block
+		void read()
+		{
+			StageStats stage = { 0, 0, 0, 0.0, 0.0 };
+			std::vector<char> carry;
+			size_t sequence = 0;
+			bool end = false;
+			while (!end) {
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				ImportBlock* block = nullptr;
+				free.pop(block);
+				stage.stalled += secondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				size_t used = carry.size();
+				if (block->data.size() < used + import_block_size)
+					block->data.resize(used + import_block_size);
+				if (used != 0)
+					memcpy(block->data.data(), carry.data(), used);
+				carry.clear();
+				for (;;) {
+					size_t wanted = block->data.size() - used;
+					size_t got = fread(block->data.data() + used, 1, wanted, file);
+					used += got;
+					if (got < wanted) {
+						end = true;
+						if (ferror(file) != 0)
+							failed = true;
+						break;
+					}
+					size_t last = used;
+					while (last != 0 && block->data[last - 1] != '\n')
+						--last;
+					if (last != 0) {
+						carry.assign(block->data.begin() + last, block->data.begin() + used);
+						used = last;
+						break;
+					}
+					//a line longer than the block: grow the block until it holds the whole line
+					block->data.resize(block->data.size() * 2);
+				}
+				block->size = used;
+				stage.busy += secondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				if (used != 0) {
+					block->sequence = sequence++;
+					++stage.blocks;
+					stage.bytes += used;
+					filled.push(block);
+				}
+				else {
+					free.push(block);
+				}
+				stage.stalled += secondsSince(start);
+			}
+			//the statistics are recorded before the queue is closed, which the inserter waits for through the parsers
+			counts.read = stage;
+			filled.close();
+		}
+
+		//parses blocks until the reader is done; the last parser to finish closes the parsed queue
+		void parse()
+		{
+			StageStats stage = { 0, 0, 0, 0.0, 0.0 };
+			for (;;) {
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				ImportBlock* block = nullptr;
+				bool more = filled.pop(block);
+				stage.stalled += secondsSince(start);
+				if (!more)
+					break;
+
+				start = std::chrono::steady_clock::now();
+				const char* cursor = block->data.data();
+				const char* last = cursor + block->size;
+				ProductRecord record;
+				block->records.clear();
+				block->rejected = 0;
+				while (ProductRecord::next(cursor, last)) {
+					if (record.parse(cursor, last))
+						block->records.push_back(record);
+					else
+						++block->rejected;
+				}
+				++stage.blocks;
+				stage.bytes += block->size;
+				stage.records += block->records.size();
+				stage.busy += secondsSince(start);
+
+				start = std::chrono::steady_clock::now();
+				parsed.push(block);
+				stage.stalled += secondsSince(start);
+			}
+			std::lock_guard<std::mutex> guard(lock);
+			counts.parse.blocks += stage.blocks;
+			counts.parse.bytes += stage.bytes;
+			counts.parse.records += stage.records;
+			counts.parse.busy += stage.busy;
+			counts.parse.stalled += stage.stalled;
+			if (--running == 0)
+				parsed.close();
+		}
+
+	public:
+
+		//starts the reader and the parsers on the open file
+		ImportPipeline(FILE* file_, unsigned threads) : file(file_), pool(threads * blocks_per_parser +
+			blocks_outside_parsers), free(pool.size()), filled(pool.size()), parsed(pool.size()), running(threads),
+			failed(false)
+		{
+			counts = PipelineStats{ { 0, 0, 0, 0.0, 0.0 }, { 0, 0, 0, 0.0, 0.0 }, { 0, 0, 0, 0.0, 0.0 }, { 0, 0 }, 0.0 };
+			for (ImportBlock& block : pool)
+				free.push(&block);
+			reader = std::thread(&ImportPipeline::read, this);
+			for (unsigned t = 0; t < threads; ++t)
+				parsers.push_back(std::thread(&ImportPipeline::parse, this));
+		}
+
+		ImportPipeline(const ImportPipeline&) = delete;
+		ImportPipeline& operator=(const ImportPipeline&) = delete;
+
+		~ImportPipeline()
+		{
+			reader.join();
+			for (std::thread& parser : parsers)
+				parser.join();
+		}
+
+		/*This function calls sink(records) for the records of every block in file order, as the blocks are parsed,
+		and returns true if the file was read to the end. Blocks that are parsed ahead of their turn wait in a window
+		with one place per block of the pool, which is enough as no more blocks than that are ever in flight.*/
+		template <typename Sink>
+		bool insert(Sink sink, PipelineStats& stats)
+		{
+			StageStats stage = { 0, 0, 0, 0.0, 0.0 };
+			LoadStats totals = { 0, 0 };
+			std::vector<ImportBlock*> window(pool.size(), nullptr);
+			size_t next = 0;
+			for (;;) {
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				ImportBlock* block = nullptr;
+				bool more = parsed.pop(block);
+				stage.stalled += secondsSince(start);
+				if (!more)
+					break;
+
+				start = std::chrono::steady_clock::now();
+				window[block->sequence % window.size()] = block;
+				ImportBlock* ready;
+				while ((ready = window[next % window.size()]) != nullptr && ready->sequence == next) {
+					window[next % window.size()] = nullptr;
+					sink(ready->records);
+					++stage.blocks;
+					stage.bytes += ready->size;
+					stage.records += ready->records.size();
+					totals.records += ready->records.size();
+					totals.rejected += ready->rejected;
+					free.push(ready);
+					++next;
+				}
+				stage.busy += secondsSince(start);
+			}
+			stats = counts;
+			stats.insert = stage;
+			stats.counts = totals;
+			return !failed;
+		}
+	};
+
+	//returns the number of parser threads for the given request
+	static unsigned parserCount(unsigned parsers)
+	{
+		if (parsers == 0) {
+			unsigned threads = std::thread::hardware_concurrency();
+			parsers = threads > 2 ? threads - 2 : 1;
+		}
+		return parsers;
+	}
+
+	/*This function runs an import pipeline over the named file, handing the records of every block to sink.*/
+	template <typename Sink>
+	static bool runPipeline(const char* filename, unsigned parsers, PipelineStats* stats, Sink sink)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		FILE* file = fopen(filename, "rb");
+		if (file == nullptr)
+			return false;
+		//the blocks are the buffers: no need for the stream to copy the file through one of its own
+		setvbuf(file, nullptr, _IONBF, 0);
+		PipelineStats counts;
+		bool complete;
+		{
+			ImportPipeline pipeline(file, parserCount(parsers));
+			complete = pipeline.insert(sink, counts);
+		}
+		fclose(file);
+		counts.seconds = secondsSince(start);
+		if (stats != nullptr)
+			*stats = counts;
+		return complete;
+	}
+
+	/*This function loads the named product file into the store through an import pipeline.*/
+	bool loadPipelined(const char * filename, InventoryStore & store, unsigned parsers, PipelineStats * stats)
+	{
+		return runPipeline(filename, parsers, stats, [&store](const std::vector<ProductRecord>& records) {
+			for (const ProductRecord& record : records)
+				store.insert(record);
+		});
+	}
+
+	/*This function appends one new Product or Perishable per record of the named file to the vector through an
+	import pipeline.*/
+	bool loadPipelined(const char * filename, std::vector<iProduct*>& products, unsigned parsers, PipelineStats * stats)
+	{
+		return runPipeline(filename, parsers, stats, [&products](const std::vector<ProductRecord>& records) {
+			for (const ProductRecord& record : records)
+				products.push_back(record.create());
+		});
+	}
+}
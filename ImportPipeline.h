@@ -0,0 +1,55 @@
+//The import pipeline loads a product file in three stages running on their own threads: a reader, a pool of parsers
+//and an inserter, connected by bounded queues.
+
+#ifndef GMS_ImportPipeline_H
+#define GMS_ImportPipeline_H
+
+#include <vector>
+#include "iProduct.h"
+#include "InventoryStore.h"
+#include "MappedLoader.h"
+
+namespace GMS {
+
+	//the number of bytes the reader of an import pipeline reads into a block
+	const size_t import_block_size = size_t(1) << 20;
+
+	//The activity of one stage of an import pipeline, summed over the threads of the stage.
+	struct StageStats {
+		//the blocks, bytes and records the stage has handled (the reader handles no records)
+		unsigned long long blocks;
+		unsigned long long bytes;
+		unsigned long long records;
+		//the seconds spent working, and waiting for input or for room in the next queue
+		double busy;
+		double stalled;
+
+		//This query returns the bytes handled per second of work (zero if the stage did no work).
+		double throughput() const;
+	};
+
+	//The statistics of a pipelined load: each stage, the record counts and the elapsed time of the whole load.
+	struct PipelineStats {
+		StageStats read;
+		StageStats parse;
+		StageStats insert;
+		LoadStats counts;
+		double seconds;
+	};
+
+	/*These functions load the named product file like loadMapped, without mapping it. The reader thread reads the file
+	in large blocks (import_block_size bytes, extended to the end of the last complete line), the parser threads parse the
+	blocks into records, and the calling thread inserts the records into the store, copying their names (or appends
+	one new Product or Perishable per record to the vector), strictly in file order: the result is the same as
+	loadMapped, including which record wins when several share a sku. Reading, parsing and inserting overlap.
+
+	The blocks circulate through a fixed pool of two blocks per parser plus two: the reader waits for a free block
+	when the parsers or the inserter fall behind, so memory stays bounded however large the file is. A parser count
+	of zero uses every hardware thread but the two taken by the reader and the inserter (at least one parser). They
+	return false if the file cannot be opened or cannot be read to the end; stats, if not nullptr, receives the
+	counts and the activity of every stage.*/
+	bool loadPipelined(const char* filename, InventoryStore& store, unsigned parsers = 0, PipelineStats* stats = nullptr);
+	bool loadPipelined(const char* filename, std::vector<iProduct*>& products, unsigned parsers = 0,
+		PipelineStats* stats = nullptr);
+}
+#endif // !GMS_ImportPipeline_H
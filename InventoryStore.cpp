@@ -0,0 +1,894 @@
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	//the position in the reorder set of a row that is not in it
+	static const size_t unlisted = InventoryStore::npos;
+
+	//copies a C-style string into a fixed-width cell, truncating it to the cell capacity
+	template <size_t N>
+	static void copyCell(char (&cell)[N], const char* text)
+	{
+		if (text != nullptr) {
+			strncpy(cell, text, N - 1);
+			cell[N - 1] = '\0';
+		}
+		else {
+			cell[0] = '\0';
+		}
+	}
+
+	//This constructor binds the view to the row of the referenced store.
+	ProductView::ProductView(InventoryStore& store, size_t row_) : inventory(&store), row(row_)
+	{
+	}
+
+	//This query returns the row of the store the view is bound to.
+	size_t ProductView::index() const
+	{
+		return row;
+	}
+
+	//This query inserts the row into the fstream object as a comma separated file record, exactly as Product::store
+	//and Perishable::store do.
+	std::fstream & ProductView::store(std::fstream & file, bool newLine) const
+	{
+		if (inventory->type(row) == 'P') {
+			Perishable temp;
+			inventory->copy(row, temp);
+			temp.store(file, newLine);
+		}
+		else {
+			Product temp;
+			inventory->copy(row, temp);
+			temp.store(file, newLine);
+		}
+		return file;
+	}
+
+	//This modifier extracts a single file record (without its leading type tag) from the fstream object and
+	//replaces the fields of the row with it.
+	std::fstream & ProductView::load(std::fstream & file)
+	{
+		if (inventory->type(row) == 'P') {
+			Perishable temp;
+			temp.load(file);
+			inventory->assign(row, temp);
+		}
+		else {
+			Product temp;
+			temp.load(file);
+			inventory->assign(row, temp);
+		}
+		return file;
+	}
+
+	//This query inserts the row into the ostream object in the layout of Product::write and Perishable::write.
+	std::ostream & ProductView::write(std::ostream & os, bool linear) const
+	{
+		if (inventory->type(row) == 'P') {
+			Perishable temp;
+			inventory->copy(row, temp);
+			temp.write(os, linear);
+		}
+		else {
+			Product temp;
+			inventory->copy(row, temp);
+			temp.write(os, linear);
+		}
+		return os;
+	}
+
+	/*This modifier extracts the fields of the row from the istream object, prompting like Product::read and
+	Perishable::read. The row is only modified if all the input has been accepted; the store does not keep
+	the error message of a failed entry.*/
+	std::istream & ProductView::read(std::istream & is)
+	{
+		if (inventory->type(row) == 'P') {
+			Perishable temp;
+			temp.read(is);
+			if (!is.fail())
+				inventory->assign(row, temp);
+		}
+		else {
+			Product temp;
+			temp.read(is);
+			if (!is.fail())
+				inventory->assign(row, temp);
+		}
+		return is;
+	}
+
+	bool ProductView::operator==(const char * sku) const
+	{
+		return strcmp(inventory->sku(row), sku) == 0;
+	}
+
+	double ProductView::total_cost() const
+	{
+		return inventory->total_cost(row);
+	}
+
+	const char * ProductView::name() const
+	{
+		return inventory->name(row);
+	}
+
+	void ProductView::quantity(int qtyOnHand)
+	{
+		inventory->quantity(row, qtyOnHand);
+	}
+
+	int ProductView::qtyNeeded() const
+	{
+		return inventory->qtyNeeded(row);
+	}
+
+	int ProductView::quantity() const
+	{
+		return inventory->quantity(row);
+	}
+
+	int ProductView::operator+=(int units)
+	{
+		return inventory->receive(row, units);
+	}
+
+	//This query returns true if the name of the row is greater than the name of the referenced iProduct.
+	bool ProductView::operator>(const iProduct & product) const
+	{
+		const char* lhs = name();
+		const char* rhs = product.name();
+		return strcmp(lhs ? lhs : "", rhs ? rhs : "") > 0;
+	}
+
+	//This constructor creates an empty store.
+	InventoryStore::InventoryStore() : total_short(0), taxed_total(0.0), untaxed_total(0.0), units_total(0), changes(0)
+	{
+	}
+
+	size_t InventoryStore::size() const
+	{
+		return product_types.size();
+	}
+
+	bool InventoryStore::empty() const
+	{
+		return product_types.empty();
+	}
+
+	void InventoryStore::reserve(size_t count)
+	{
+		sku_index.reserve(count);
+		product_types.reserve(count);
+		skus.reserve(count);
+		names.reserve(count);
+		units.reserve(count);
+		quantities_on_hand.reserve(count);
+		quantities_needed.reserve(count);
+		unit_prices.reserve(count);
+		taxable_flags.reserve(count);
+		expiry_dates.reserve(count);
+		reorder_slots.reserve(count);
+		name_index.reserve(count);
+	}
+
+	void InventoryStore::clear()
+	{
+		product_types.clear();
+		skus.clear();
+		names.clear();
+		units.clear();
+		quantities_on_hand.clear();
+		quantities_needed.clear();
+		unit_prices.clear();
+		taxable_flags.clear();
+		expiry_dates.clear();
+		sku_index.clear();
+		expiry_index.clear();
+		name_index.clear();
+		name_grams.clear();
+		reorder_rows.clear();
+		reorder_slots.clear();
+		total_short = 0;
+		taxed_total = 0.0;
+		untaxed_total = 0.0;
+		units_total = 0;
+		changes = 0;
+		name_arena.clear();
+		mappings.clear();
+	}
+
+	//This modifier makes the store the owner of a mapped file.
+	void InventoryStore::attach(std::unique_ptr<MappedFile> file)
+	{
+		mappings.push_back(std::move(file));
+	}
+
+	//interns a name into name_arena and returns the address of the interned copy
+	const char * InventoryStore::own(const char * name, size_t length)
+	{
+		if (name == nullptr || length == 0)
+			return "";
+		return name_arena.intern(name, length);
+	}
+
+	const char * InventoryStore::own(const char * name)
+	{
+		return own(name, name != nullptr ? strlen(name) : 0);
+	}
+
+	//finds the row holding the sku, appending and indexing a new row if there is none
+	size_t InventoryStore::slot(const char * sku)
+	{
+		size_t row = sku_index.find(sku);
+		if (row == npos) {
+			row = append();
+			copyCell(skus[row].text, sku);
+			sku_index.insert(sku, row);
+		}
+		return row;
+	}
+
+	size_t InventoryStore::append()
+	{
+		SkuCell skuCell = { { '\0' } };
+		UnitCell unitCell = { { '\0' } };
+		product_types.push_back('N');
+		skus.push_back(skuCell);
+		names.push_back("");
+		units.push_back(unitCell);
+		quantities_on_hand.push_back(0);
+		quantities_needed.push_back(0);
+		unit_prices.push_back(0.0);
+		taxable_flags.push_back(1);
+		expiry_dates.push_back(Date());
+		reorder_slots.push_back(unlisted);
+		return product_types.size() - 1;
+	}
+
+	void InventoryStore::put(size_t row, char type, const char * name, const char * unit, bool taxed, double price,
+		int qtyOnHand, int qtyNeeded, const Date & expiry)
+	{
+		product_types[row] = type;
+		names[row] = name;
+		copyCell(units[row].text, unit);
+		quantities_on_hand[row] = qtyOnHand;
+		quantities_needed[row] = qtyNeeded;
+		unit_prices[row] = price;
+		taxable_flags[row] = taxed ? 1 : 0;
+		expiry_dates[row] = type == 'P' ? expiry : Date();
+	}
+
+	void InventoryStore::update(size_t row, char type, const char * name, const char * unit, bool taxed, double price,
+		int qtyOnHand, int qtyNeeded, const Date & expiry)
+	{
+		const char* before = names[row];
+		unlistExpiry(row);
+		unlistTotals(row);
+		put(row, type, name, unit, taxed, price, qtyOnHand, qtyNeeded, expiry);
+		name_index.assign(row, names[row]);
+		regram(row, before);
+		listExpiry(row);
+		listTotals(row);
+	}
+
+	void InventoryStore::listExpiry(size_t row)
+	{
+		unsigned long long key = SkuIndex::pack(skus[row].text);
+		if (product_types[row] == 'P' && expiry_dates[row].key() != 0 && key != 0)
+			expiry_index.insert(std::make_pair(expiry_dates[row].key(), key));
+	}
+
+	void InventoryStore::unlistExpiry(size_t row)
+	{
+		unsigned long long key = SkuIndex::pack(skus[row].text);
+		if (product_types[row] == 'P' && expiry_dates[row].key() != 0 && key != 0)
+			expiry_index.erase(std::make_pair(expiry_dates[row].key(), key));
+	}
+
+	void InventoryStore::regram(size_t row, const char * before)
+	{
+		if (name_grams.built() && strcmp(before, names[row]) != 0) {
+			name_grams.drop(before);
+			name_grams.add(row, names[row]);
+			if (name_grams.wasteful())
+				name_grams.build(names.data(), names.size());
+		}
+	}
+
+	//Once the store has changed as many rows as it holds since the last recount, the totals are recomputed.
+	void InventoryStore::listTotals(size_t row)
+	{
+		long long missing = shortfall(row);
+		if (missing > 0) {
+			reorder_slots[row] = reorder_rows.size();
+			reorder_rows.push_back(row);
+			total_short += missing;
+		}
+		if (taxable_flags[row])
+			taxed_total += total_cost(row);
+		else
+			untaxed_total += total_cost(row);
+		units_total += quantities_on_hand[row];
+		if (++changes > running_recount && changes > size())
+			recount();
+	}
+
+	//the last row of the set takes the place of the removed one
+	void InventoryStore::unlistTotals(size_t row)
+	{
+		if (taxable_flags[row])
+			taxed_total -= total_cost(row);
+		else
+			untaxed_total -= total_cost(row);
+		units_total -= quantities_on_hand[row];
+		size_t position = reorder_slots[row];
+		if (position != unlisted) {
+			size_t moved = reorder_rows.back();
+			reorder_rows[position] = moved;
+			reorder_slots[moved] = position;
+			reorder_rows.pop_back();
+			reorder_slots[row] = unlisted;
+			total_short -= shortfall(row);
+		}
+	}
+
+	/*This modifier appends a product to the store from its individual fields and returns its row. A product whose
+	sku is already stored overwrites the existing row instead.*/
+	size_t InventoryStore::insert(char type, const char * sku, const char * name, const char * unit, bool taxed, double price,
+		int qtyOnHand, int qtyNeeded, const Date & expiry)
+	{
+		size_t row = slot(sku);
+		update(row, type, own(name), unit, taxed, price, qtyOnHand, qtyNeeded, expiry);
+		return row;
+	}
+
+	//The row type is taken from the static type of the argument: 'N' for a Product and 'P' for a Perishable.
+	size_t InventoryStore::insert(const Product & product)
+	{
+		return insert('N', product.psku, product.product_name, product.product_unit_descrp, product.taxable_product,
+			product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed);
+	}
+
+	size_t InventoryStore::insert(const Perishable & product)
+	{
+		return insert('P', product.psku, product.product_name, product.product_unit_descrp, product.taxable_product,
+			product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed, product.per_prod_exp_date);
+	}
+
+	size_t InventoryStore::insert(const iProduct & product)
+	{
+		size_t row = size();
+		const Perishable* perishable = dynamic_cast<const Perishable*>(&product);
+		const Product* general = dynamic_cast<const Product*>(&product);
+		const ProductView* view = dynamic_cast<const ProductView*>(&product);
+
+		if (perishable != nullptr) {
+			row = insert(*perishable);
+		}
+		else if (general != nullptr) {
+			row = insert(*general);
+		}
+		else if (view != nullptr) {
+			const InventoryStore& src = *view->inventory;
+			size_t i = view->row;
+			//copy the fields first: src may be this store and inserting may reallocate its columns
+			SkuCell skuCell = src.skus[i];
+			UnitCell unitCell = src.units[i];
+			Date expiry = src.expiry_dates[i];
+			row = slot(skuCell.text);
+			//within a store the name is shared, from another store it is interned into this one
+			const char* name = &src == this ? src.names[i] : own(src.names[i]);
+			update(row, src.product_types[i], name, unitCell.text, src.taxable_flags[i] != 0, src.unit_prices[i],
+				src.quantities_on_hand[i], src.quantities_needed[i], expiry);
+		}
+		return row;
+	}
+
+	//This modifier appends a parsed file record to the store, copying its name, and returns its row.
+	size_t InventoryStore::insert(const ProductRecord & record)
+	{
+		size_t row = slot(record.sku);
+		update(row, record.type, own(record.name, record.name_length), record.unit, record.taxed, record.price,
+			record.quantity, record.needed, record.expiry);
+		return row;
+	}
+
+	//This modifier appends a parsed file record to the store without copying its (null-terminated) name.
+	size_t InventoryStore::insertBorrowed(const ProductRecord & record)
+	{
+		size_t row = slot(record.sku);
+		update(row, record.type, record.name, record.unit, record.taxed, record.price, record.quantity, record.needed,
+			record.expiry);
+		return row;
+	}
+
+	//This modifier appends a parsed file record without looking up or indexing its sku.
+	size_t InventoryStore::appendBorrowed(const ProductRecord & record)
+	{
+		size_t row = append();
+		fill(row, record);
+		return row;
+	}
+
+	//This modifier appends the given number of empty rows to every column and returns the first of them.
+	size_t InventoryStore::extend(size_t count)
+	{
+		size_t first = size();
+		SkuCell skuCell = { { '\0' } };
+		UnitCell unitCell = { { '\0' } };
+		product_types.resize(first + count, 'N');
+		skus.resize(first + count, skuCell);
+		names.resize(first + count, "");
+		units.resize(first + count, unitCell);
+		quantities_on_hand.resize(first + count, 0);
+		quantities_needed.resize(first + count, 0);
+		unit_prices.resize(first + count, 0.0);
+		taxable_flags.resize(first + count, 1);
+		expiry_dates.resize(first + count, Date());
+		reorder_slots.resize(first + count, unlisted);
+		return first;
+	}
+
+	//This modifier stores a parsed file record in a row appended by extend, touching no other row and no index.
+	void InventoryStore::fill(size_t row, const ProductRecord & record)
+	{
+		copyCell(skus[row].text, record.sku);
+		put(row, record.type, record.name, record.unit, record.taxed, record.price, record.quantity, record.needed,
+			record.expiry);
+	}
+
+	//This modifier copies a name into the store and returns the address of the stored copy.
+	const char * InventoryStore::intern(const char * name, size_t length)
+	{
+		return own(name, length);
+	}
+
+	//This modifier rebuilds the sku index, the expiry index, the name indexes, the reorder set and the running totals
+	void InventoryStore::reindex()
+	{
+		std::vector<unsigned long long> keys(size());
+		std::vector<std::pair<int, unsigned long long>> dated;
+		for (size_t row = 0; row < keys.size(); ++row) {
+			keys[row] = SkuIndex::pack(skus[row].text);
+			if (product_types[row] == 'P' && expiry_dates[row].key() != 0 && keys[row] != 0)
+				dated.push_back(std::make_pair(expiry_dates[row].key(), keys[row]));
+		}
+		sku_index.build(keys.data(), keys.size());
+		name_index.build(names.data(), names.size());
+		if (name_grams.built())
+			name_grams.build(names.data(), names.size());
+		resync();
+
+		//a set built from a sorted range is built in linear time
+		std::sort(dated.begin(), dated.end());
+		expiry_index = std::set<std::pair<int, unsigned long long>>(dated.begin(), dated.end());
+	}
+
+	/*This modifier removes the product in the given row. The last row of the store is moved into the freed slot.*/
+	void InventoryStore::erase(size_t row)
+	{
+		size_t last = size() - 1;
+		unlistExpiry(row);
+		unlistTotals(row);
+		sku_index.erase(skus[row].text);
+		name_index.erase(row, last);
+		name_grams.drop(names[row]);
+		if (row != last) {
+			name_grams.drop(names[last]);
+			unlistTotals(last);
+			sku_index.insert(skus[last].text, row);
+			product_types[row] = product_types[last];
+			skus[row] = skus[last];
+			names[row] = names[last];
+			units[row] = units[last];
+			quantities_on_hand[row] = quantities_on_hand[last];
+			quantities_needed[row] = quantities_needed[last];
+			unit_prices[row] = unit_prices[last];
+			taxable_flags[row] = taxable_flags[last];
+			expiry_dates[row] = expiry_dates[last];
+		}
+		product_types.pop_back();
+		skus.pop_back();
+		names.pop_back();
+		units.pop_back();
+		quantities_on_hand.pop_back();
+		quantities_needed.pop_back();
+		unit_prices.pop_back();
+		taxable_flags.pop_back();
+		expiry_dates.pop_back();
+		reorder_slots.pop_back();
+		//listed once the columns are consistent again, in case listing recounts the totals
+		if (row != last) {
+			listTotals(row);
+			name_grams.add(row, names[row]);
+		}
+		if (name_grams.wasteful())
+			name_grams.build(names.data(), names.size());
+	}
+
+	/*This modifier replaces every field of the given row with the fields of the referenced product. If the new sku
+	is held by another row, that other row is erased.*/
+	void InventoryStore::assign(size_t row, const Product & product)
+	{
+		update(row, 'N', own(product.product_name), product.product_unit_descrp, product.taxable_product,
+			product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed, Date());
+		rekey(row, product.psku);
+	}
+
+	void InventoryStore::assign(size_t row, const Perishable & product)
+	{
+		update(row, 'P', own(product.product_name), product.product_unit_descrp, product.taxable_product,
+			product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed, product.per_prod_exp_date);
+		rekey(row, product.psku);
+	}
+
+	//changes the sku of the row, erasing any other row that holds the new sku
+	void InventoryStore::rekey(size_t row, const char * sku)
+	{
+		unsigned long long key = SkuIndex::pack(sku);
+		if (key != SkuIndex::pack(skus[row].text)) {
+			size_t other = sku_index.find(key);
+			unlistExpiry(row);
+			if (other != npos)
+				unlistExpiry(other);
+			sku_index.erase(skus[row].text);
+			copyCell(skus[row].text, sku);
+			sku_index.insert(key, row);
+			listExpiry(row);
+			if (other != npos) {
+				//the index entries now belong to row; blank the old holder so that erase leaves them alone
+				skus[other].text[0] = '\0';
+				erase(other);
+			}
+		}
+	}
+
+	//This query returns the row of the product with the given sku, or npos if there is none.
+	size_t InventoryStore::find(const char * sku) const
+	{
+		return sku_index.find(sku);
+	}
+
+	ProductView InventoryStore::view(size_t row)
+	{
+		return ProductView(*this, row);
+	}
+
+	//This query copies the given row into the referenced product.
+	void InventoryStore::copy(size_t row, Product & product) const
+	{
+		strcpy(product.psku, skus[row].text);
+		product.name(nullptr);
+		product.name(names[row]);
+		strcpy(product.product_unit_descrp, units[row].text);
+		product.quantity_on_hand = quantities_on_hand[row];
+		product.quantity_needed = quantities_needed[row];
+		product.unit_price_before_tax = unit_prices[row];
+		product.taxable_product = taxable_flags[row] != 0;
+		product.ErrState.message("");
+	}
+
+	void InventoryStore::copy(size_t row, Perishable & product) const
+	{
+		copy(row, static_cast<Product&>(product));
+		product.per_prod_exp_date = expiry_dates[row];
+	}
+
+	//This query allocates a new Product or Perishable holding a copy of the given row and returns its address.
+	iProduct * InventoryStore::product(size_t row) const
+	{
+		if (product_types[row] == 'P') {
+			Perishable* perishable = new Perishable();
+			copy(row, *perishable);
+			return perishable;
+		}
+		else {
+			Product* general = new Product(product_types[row]);
+			copy(row, *general);
+			return general;
+		}
+	}
+
+	char InventoryStore::type(size_t row) const
+	{
+		return product_types[row];
+	}
+
+	const char * InventoryStore::sku(size_t row) const
+	{
+		return skus[row].text;
+	}
+
+	const char * InventoryStore::name(size_t row) const
+	{
+		return names[row][0] == '\0' ? nullptr : names[row];
+	}
+
+	const char * InventoryStore::unit(size_t row) const
+	{
+		return units[row].text;
+	}
+
+	bool InventoryStore::taxed(size_t row) const
+	{
+		return taxable_flags[row] != 0;
+	}
+
+	double InventoryStore::price(size_t row) const
+	{
+		return unit_prices[row];
+	}
+
+	double InventoryStore::cost(size_t row) const
+	{
+		if (taxable_flags[row])
+			return unit_prices[row] * TAX_RATE + unit_prices[row];
+		else
+			return unit_prices[row];
+	}
+
+	int InventoryStore::quantity(size_t row) const
+	{
+		return quantities_on_hand[row];
+	}
+
+	int InventoryStore::qtyNeeded(size_t row) const
+	{
+		return quantities_needed[row];
+	}
+
+	const Date & InventoryStore::expiry(size_t row) const
+	{
+		return expiry_dates[row];
+	}
+
+	double InventoryStore::total_cost(size_t row) const
+	{
+		return cost(row) * quantities_on_hand[row];
+	}
+
+	void InventoryStore::name(size_t row, const char * name)
+	{
+		const char* before = names[row];
+		names[row] = own(name);
+		name_index.assign(row, names[row]);
+		regram(row, before);
+	}
+
+	void InventoryStore::quantity(size_t row, int qtyOnHand)
+	{
+		unlistTotals(row);
+		quantities_on_hand[row] = qtyOnHand;
+		listTotals(row);
+	}
+
+	void InventoryStore::qtyNeeded(size_t row, int qtyNeeded)
+	{
+		unlistTotals(row);
+		quantities_needed[row] = qtyNeeded;
+		listTotals(row);
+	}
+
+	void InventoryStore::price(size_t row, double price)
+	{
+		unlistTotals(row);
+		unit_prices[row] = price;
+		listTotals(row);
+	}
+
+	//If the number of units is positive, adds it to the quantity on hand; otherwise does nothing.
+	int InventoryStore::receive(size_t row, int units)
+	{
+		if (units > 0) {
+			unlistTotals(row);
+			quantities_on_hand[row] += units;
+			listTotals(row);
+		}
+		return quantities_on_hand[row];
+	}
+
+	const char * InventoryStore::types() const
+	{
+		return product_types.empty() ? nullptr : product_types.data();
+	}
+
+	const int * InventoryStore::quantities() const
+	{
+		return quantities_on_hand.empty() ? nullptr : quantities_on_hand.data();
+	}
+
+	const int * InventoryStore::needed() const
+	{
+		return quantities_needed.empty() ? nullptr : quantities_needed.data();
+	}
+
+	const double * InventoryStore::prices() const
+	{
+		return unit_prices.empty() ? nullptr : unit_prices.data();
+	}
+
+	const unsigned char * InventoryStore::taxable() const
+	{
+		return taxable_flags.empty() ? nullptr : taxable_flags.data();
+	}
+
+	//This query returns the total cost of all units on hand of all products, taxes included. Only the price,
+	//taxable and quantity columns are read.
+	double InventoryStore::total_cost() const
+	{
+		const size_t count = size();
+		const double* price = unit_prices.data();
+		const unsigned char* taxed = taxable_flags.data();
+		const int* qty = quantities_on_hand.data();
+		double total = 0.0;
+		for (size_t i = 0; i < count; ++i) {
+			double cost = taxed[i] ? price[i] * TAX_RATE + price[i] : price[i];
+			total += cost * qty[i];
+		}
+		return total;
+	}
+
+	double InventoryStore::value() const
+	{
+		return taxed_total + untaxed_total;
+	}
+
+	double InventoryStore::taxed_value() const
+	{
+		return taxed_total;
+	}
+
+	double InventoryStore::untaxed_value() const
+	{
+		return untaxed_total;
+	}
+
+	//This query returns the number of units on hand of all products.
+	long long InventoryStore::total_quantity() const
+	{
+		return units_total;
+	}
+
+	//This modifier recomputes the running totals from the columns in a single pass.
+	void InventoryStore::recount()
+	{
+		const size_t count = size();
+		const double* price = unit_prices.data();
+		const unsigned char* taxed = taxable_flags.data();
+		const int* qty = quantities_on_hand.data();
+		double sums[2] = { 0.0, 0.0 };
+		long long units = 0;
+		for (size_t i = 0; i < count; ++i) {
+			double cost = taxed[i] ? price[i] * TAX_RATE + price[i] : price[i];
+			sums[taxed[i] ? 0 : 1] += cost * qty[i];
+			units += qty[i];
+		}
+		taxed_total = sums[0];
+		untaxed_total = sums[1];
+		units_total = units;
+		changes = 0;
+	}
+
+	//This modifier relists every row with a shortfall in the reorder set, then recounts the running totals.
+	void InventoryStore::resync()
+	{
+		reorder_rows.clear();
+		reorder_slots.assign(size(), unlisted);
+		total_short = 0;
+		for (size_t row = 0; row < size(); ++row) {
+			long long missing = shortfall(row);
+			if (missing > 0) {
+				reorder_slots[row] = reorder_rows.size();
+				reorder_rows.push_back(row);
+				total_short += missing;
+			}
+		}
+		recount();
+	}
+
+	//appends the rows of the expiry index entries in [first, last) to rows
+	template <typename Iterator>
+	void InventoryStore::rowsOf(Iterator first, Iterator last, std::vector<size_t>& rows) const
+	{
+		for (; first != last; ++first)
+			rows.push_back(sku_index.find(first->second));
+	}
+
+	/*This query appends to rows the rows of the perishable products that expire between first and last inclusive,
+	in order of expiry date.*/
+	void InventoryStore::expiring(const Date & first, const Date & last, std::vector<size_t>& rows) const
+	{
+		//sku keys are never zero, so (key, 0) sorts before every entry of that day
+		std::set<std::pair<int, unsigned long long>>::const_iterator begin = expiry_index.begin();
+		std::set<std::pair<int, unsigned long long>>::const_iterator end = expiry_index.end();
+		if (first.key() != 0)
+			begin = expiry_index.lower_bound(std::make_pair(first.key(), 0ULL));
+		if (last.key() != 0)
+			end = expiry_index.lower_bound(std::make_pair(last.key() + 1, 0ULL));
+		if (first.key() == 0 || last.key() == 0 || first.key() <= last.key())
+			rowsOf(begin, end, rows);
+	}
+
+	//This query returns the number of perishable products that expire before the given date.
+	size_t InventoryStore::countExpiringBefore(const Date & date) const
+	{
+		return (size_t)std::distance(expiry_index.begin(), expiry_index.lower_bound(std::make_pair(date.key(), 0ULL)));
+	}
+
+	//This query appends to rows the rows of every dated perishable product, in order of expiry date.
+	void InventoryStore::byExpiry(std::vector<size_t>& rows) const
+	{
+		rowsOf(expiry_index.begin(), expiry_index.end(), rows);
+	}
+
+	long long InventoryStore::shortfall(size_t row) const
+	{
+		long long missing = (long long)quantities_needed[row] - quantities_on_hand[row];
+		return missing > 0 ? missing : 0;
+	}
+
+	size_t InventoryStore::reorderCount() const
+	{
+		return reorder_rows.size();
+	}
+
+	long long InventoryStore::total_shortfall() const
+	{
+		return total_short;
+	}
+
+	//This query appends to rows the rows of the products that need more units than they have on hand.
+	void InventoryStore::reorder(std::vector<size_t>& rows, bool largestFirst) const
+	{
+		size_t first = rows.size();
+		rows.insert(rows.end(), reorder_rows.begin(), reorder_rows.end());
+		if (largestFirst) {
+			std::sort(rows.begin() + first, rows.end(), [this](size_t a, size_t b) {
+				long long x = shortfall(a), y = shortfall(b);
+				return x != y ? x > y : a < b;
+			});
+		}
+	}
+
+	void InventoryStore::byName(std::vector<size_t>& rows) const
+	{
+		name_index.rows(rows);
+	}
+
+	void InventoryStore::findName(const char * name, std::vector<size_t>& rows) const
+	{
+		name_index.find(name, rows);
+	}
+
+	void InventoryStore::nameStarting(const char * prefix, std::vector<size_t>& rows) const
+	{
+		name_index.prefix(prefix, rows);
+	}
+
+	void InventoryStore::sortNames()
+	{
+		name_index.merge();
+	}
+
+	void InventoryStore::indexSubstrings()
+	{
+		name_grams.build(names.data(), names.size());
+	}
+
+	void InventoryStore::nameContaining(const char * fragment, std::vector<size_t>& rows) const
+	{
+		name_grams.search(&fragment, 1, names.data(), names.size(), rows);
+	}
+
+	void InventoryStore::nameContaining(const char * const * fragments, size_t count, std::vector<size_t>& rows) const
+	{
+		name_grams.search(fragments, count, names.data(), names.size(), rows);
+	}
+}
@@ -0,0 +1,354 @@
+//The InventoryStore class keeps a product catalog in structure-of-arrays form: every field of every product lives in
+//its own contiguous column, so that scans over a single field (quantities, prices, ...) touch only the memory they need.
+
+#ifndef GMS_InventoryStore_H
+#define GMS_InventoryStore_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <set>
+#include <utility>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+#include "Date.h"
+#include "SkuIndex.h"
+#include "NameIndex.h"
+#include "TrigramIndex.h"
+#include "ProductRecord.h"
+#include "MappedFile.h"
+#include "StringArena.h"
+
+namespace GMS {
+
+	class InventoryStore;
+
+	/*A ProductView is a lightweight iProduct over a single row of an InventoryStore. It holds no product data of its own;
+	every query and modifier reads or writes the columns of the store directly. A view is invalidated when its row is
+	erased from the store (the last row is moved into the erased slot).*/
+	class ProductView : public iProduct {
+
+		InventoryStore* inventory;
+		size_t row;
+
+		friend class InventoryStore;
+		friend class ReportWriter;
+		friend class RecordWriter;
+
+	public:
+
+		//This constructor binds the view to the row of the referenced store.
+		ProductView(InventoryStore& store, size_t row);
+
+		//This query returns the row of the store the view is bound to.
+		size_t index() const;
+
+		//The following functions implement the iProduct interface over the row, with the same behaviour as
+		//the corresponding Product and Perishable functions.
+		std::fstream& store(std::fstream& file, bool newLine = true) const;
+		std::fstream& load(std::fstream& file);
+		std::ostream& write(std::ostream& os, bool linear) const;
+		std::istream& read(std::istream& is);
+		bool operator==(const char*) const;
+		double total_cost() const;
+		const char* name() const;
+		void quantity(int);
+		int qtyNeeded() const;
+		int quantity() const;
+		int operator+=(int);
+		bool operator>(const iProduct&) const;
+	};
+
+	class InventoryStore {
+
+		//the concurrent stock updates the quantity columns in place; the versioned store copies pages of the columns
+		friend class ConcurrentStock;
+		friend class VersionedStore;
+
+		//fixed-width cells for the sku and unit columns
+		struct SkuCell { char text[max_sku_length + 1]; };
+		struct UnitCell { char text[max_unit_length + 1]; };
+
+		//the columns, one element per product; all columns always have the same length
+		std::vector<char> product_types;
+		std::vector<SkuCell> skus;
+		//null-terminated names, either interned in name_arena or borrowed from an attached mapping
+		std::vector<const char*> names;
+		std::vector<UnitCell> units;
+		std::vector<int> quantities_on_hand;
+		std::vector<int> quantities_needed;
+		std::vector<double> unit_prices;
+		std::vector<unsigned char> taxable_flags;
+		std::vector<Date> expiry_dates;
+
+		//maps the sku of every row to the row, so that no two rows share a sku
+		SkuIndex sku_index;
+
+		/*the dated perishable products in order of expiry: one (Date::key of the expiry date, packed sku) pair for every
+		'P' row with a non-empty expiry date and a non-empty sku. Rows are identified by sku rather than by row number,
+		because erasing a product moves another one into its row.*/
+		std::set<std::pair<int, unsigned long long>> expiry_index;
+
+		//the rows in order of name, renamed, added and removed along with the rows
+		NameIndex name_index;
+		//the rows by the trigrams of their names, once indexSubstrings has been called
+		TrigramIndex name_grams;
+
+		/*the reorder set: the rows of the products with fewer units on hand than needed, in no particular order, and
+		for every row its position in reorder_rows (npos if it is not in the set), so that a row joins or leaves the
+		set in constant time. total_short is the sum of the shortfalls (needed - on hand) of the rows in the set.*/
+		std::vector<size_t> reorder_rows;
+		std::vector<size_t> reorder_slots;
+		long long total_short;
+
+		/*the running totals of all rows: the cost of the units on hand of the taxable and of the untaxed products (taxes
+		included) and the number of units on hand, with the number of rows listed since they were last recomputed*/
+		double taxed_total;
+		double untaxed_total;
+		long long units_total;
+		size_t changes;
+
+		/*the names copied into the store. Identical names share a single interned copy, and copying a name between
+		rows (or products between stores) copies its address rather than the characters.*/
+		StringArena name_arena;
+		//the mapped files that borrowed names point into
+		std::vector<std::unique_ptr<MappedFile>> mappings;
+
+		//interns a name into name_arena and returns the address of the interned copy ("" for an empty or null name)
+		const char* own(const char* name, size_t length);
+		const char* own(const char* name);
+		//finds the row holding the sku, appending and indexing a new row if there is none
+		size_t slot(const char* sku);
+
+		//appends an empty row to every column and returns it
+		size_t append();
+		//overwrites every column of the row except the sku, which is set and indexed by the callers; the name
+		//address is stored as is
+		void put(size_t row, char type, const char* name, const char* unit, bool taxed, double price,
+			int qtyOnHand, int qtyNeeded, const Date& expiry);
+		//overwrites the row like put, keeping the expiry index in sync
+		void update(size_t row, char type, const char* name, const char* unit, bool taxed, double price,
+			int qtyOnHand, int qtyNeeded, const Date& expiry);
+		//changes the sku of the row, keeping the sku and expiry indexes in sync
+		void rekey(size_t row, const char* sku);
+		//add the row to, or remove it from, the expiry index; rows that are not dated perishables are ignored
+		void listExpiry(size_t row);
+		void unlistExpiry(size_t row);
+		//records in the substring index that the name of the row was before, rebuilding the index once it is wasteful
+		void regram(size_t row, const char* before);
+		//add the row to, or remove it from, the reorder set (depending on its quantities) and the running totals; every
+		//change to the quantities or the price of a row is made between the two
+		void listTotals(size_t row);
+		void unlistTotals(size_t row);
+		//appends the rows of the expiry index entries in [first, last) to rows
+		template <typename Iterator>
+		void rowsOf(Iterator first, Iterator last, std::vector<size_t>& rows) const;
+
+	public:
+
+		//the row returned by find when no product has the sku
+		static const size_t npos = SkuIndex::npos;
+
+		//This constructor creates an empty store.
+		InventoryStore();
+		InventoryStore(const InventoryStore&) = delete;
+		InventoryStore& operator=(const InventoryStore&) = delete;
+
+		//This query returns the number of products in the store.
+		size_t size() const;
+
+		//This query returns true if the store holds no products.
+		bool empty() const;
+
+		//This modifier reserves room in every column for the given number of products.
+		void reserve(size_t count);
+
+		//This modifier removes every product from the store and releases every attached mapping.
+		void clear();
+
+		/*This modifier makes the store the owner of a mapped file, which is kept mapped until the store is cleared or
+		destroyed. Names inside the mapping can then be borrowed by insertBorrowed.*/
+		void attach(std::unique_ptr<MappedFile> file);
+
+		/*This modifier appends a product to the store from its individual fields and returns its row. The expiry date is
+		only meaningful for perishable ('P') products. Skus are unique within a store: if a product with the same sku is
+		already stored, its row is overwritten with the new fields instead, and that row is returned.*/
+		size_t insert(char type, const char* sku, const char* name, const char* unit, bool taxed, double price,
+			int qtyOnHand, int qtyNeeded, const Date& expiry = Date());
+
+		//These modifiers append a copy of the referenced product to the store (or overwrite the row holding its sku)
+		//and return its row.
+		size_t insert(const Product& product);
+		size_t insert(const Perishable& product);
+
+		//This modifier appends a copy of the referenced iProduct to the store and returns its row; the product must
+		//be a Product, a Perishable or a ProductView.
+		size_t insert(const iProduct& product);
+
+		//This modifier appends a parsed file record to the store, copying its name, and returns its row.
+		size_t insert(const ProductRecord& record);
+
+		/*This modifier appends a parsed file record to the store without copying its name, and returns its row. The name
+		of the record must be null-terminated and must stay valid as long as the store (typically it lies inside a
+		mapping attached to the store). The name is copied into the store only when it is changed.*/
+		size_t insertBorrowed(const ProductRecord& record);
+
+		/*This modifier appends a parsed file record like insertBorrowed, but neither looks up nor indexes its sku. It is
+		meant for bulk loads of records known to have unique skus, such as a snapshot: the caller must call reindex
+		once every record has been appended.*/
+		size_t appendBorrowed(const ProductRecord& record);
+
+		/*These modifiers are the parallel form of appendBorrowed. extend appends the given number of empty rows and
+		returns the first of them; fill stores a parsed file record in one of those rows without copying its name. fill
+		writes only the cells of its own row and touches no index, so several threads may fill different rows at the
+		same time. The caller must call reindex once every row has been filled.*/
+		size_t extend(size_t count);
+		void fill(size_t row, const ProductRecord& record);
+
+		/*This modifier copies a name into the store, sharing the copy of an identical name already there, and returns
+		the address of the stored copy ("" for an empty or null name), which stays valid until the store is cleared. Bulk
+		loads that decode names into a temporary buffer intern each distinct name once and append the records that use
+		it with appendBorrowed.*/
+		const char* intern(const char* name, size_t length);
+
+		//This modifier rebuilds the sku index, the expiry index, the name indexes, the reorder set and the running
+		//totals from the columns in a single pass.
+		void reindex();
+
+		/*This modifier removes the product in the given row. The last row of the store is moved into the freed slot,
+		so erasing is constant time but changes the row of the last product.*/
+		void erase(size_t row);
+
+		/*This modifier replaces every field of the given row with the fields of the referenced product. If the new sku
+		is held by another row, that other row is erased, which may move the given row (see erase).*/
+		void assign(size_t row, const Product& product);
+		void assign(size_t row, const Perishable& product);
+
+		//This query returns the row of the product with the given sku, or npos if there is none. It runs in constant
+		//expected time, using the sku index instead of comparing the sku of every product.
+		size_t find(const char* sku) const;
+
+		//This modifier returns an iProduct view of the given row.
+		ProductView view(size_t row);
+
+		//This query copies the given row into the referenced product (the expiry date is copied as well for a Perishable).
+		void copy(size_t row, Product& product) const;
+		void copy(size_t row, Perishable& product) const;
+
+		/*This query allocates a new Product or Perishable (depending on the row type) holding a copy of the given row
+		and returns its address. The caller owns the object.*/
+		iProduct* product(size_t row) const;
+
+		//row queries
+		char type(size_t row) const;
+		const char* sku(size_t row) const;
+		//returns nullptr if the product has no name, like Product::name()
+		const char* name(size_t row) const;
+		const char* unit(size_t row) const;
+		bool taxed(size_t row) const;
+		double price(size_t row) const;
+		//the price of a single unit with any tax that applies
+		double cost(size_t row) const;
+		int quantity(size_t row) const;
+		int qtyNeeded(size_t row) const;
+		const Date& expiry(size_t row) const;
+		//the cost of all the units on hand, taxes included
+		double total_cost(size_t row) const;
+
+		//row modifiers
+		void name(size_t row, const char* name);
+		void quantity(size_t row, int qtyOnHand);
+		void qtyNeeded(size_t row, int qtyNeeded);
+		void price(size_t row, double price);
+		//adds a positive number of units to the quantity on hand and returns the updated quantity, like Product::operator+=
+		int receive(size_t row, int units);
+
+		/*Column queries. These return the address of the first element of a column (nullptr when the store is empty);
+		the addresses are invalidated by any modifier that inserts or erases products.*/
+		const char* types() const;
+		const int* quantities() const;
+		const int* needed() const;
+		const double* prices() const;
+		const unsigned char* taxable() const;
+
+		//Full catalog scans.
+		//This query returns the total cost of all units on hand of all products, taxes included.
+		double total_cost() const;
+
+		/*Running totals. The store adds and subtracts the value and the units of a row as it changes, so these queries
+		take constant time. The values are sums of many additions and subtractions, which round differently from a
+		single pass over the products: the store recomputes them from the columns once it has changed as many rows as
+		it holds (and at least running_recount rows) since the last time, which bounds the drift and costs a constant
+		amortized time per change.*/
+		//the least number of changed rows between two recounts
+		static const size_t running_recount = 1 << 20;
+		//This query returns the total cost of all units on hand of all products, taxes included, like total_cost.
+		double value() const;
+		//These queries return the part of value that comes from the taxable products and from the untaxed products.
+		double taxed_value() const;
+		double untaxed_value() const;
+		//This query returns the number of units on hand of all products. It is exact, without drift, except after
+		//quantities changed through a ConcurrentStock, until resync is called.
+		long long total_quantity() const;
+		//This modifier recomputes the running totals from the columns.
+		void recount();
+		/*This modifier rebuilds the reorder set and recomputes the running totals from the columns in a single pass,
+		leaving the other indexes alone. It brings them up to date after quantities changed without going through the
+		store (ConcurrentStock).*/
+		void resync();
+
+		/*Expiry queries. These read the expiry index, which keeps the dated perishable products in order of expiry date
+		as they are inserted, changed and erased, so they take time proportional to the number of products they report
+		(plus a logarithmic search), not to the size of the store. Products that expire on the same day are reported
+		in a fixed but unspecified order. Perishable products without an expiry date or without a sku are not indexed.*/
+		//This query appends to rows the rows of the perishable products that expire on or after first and on or
+		//before last, in order of expiry date. An empty first date means no lower bound, an empty last date no upper bound.
+		void expiring(const Date& first, const Date& last, std::vector<size_t>& rows) const;
+		//This query returns the number of perishable products that expire before the given date.
+		size_t countExpiringBefore(const Date& date) const;
+		//This query appends to rows the rows of every dated perishable product, in order of expiry date.
+		void byExpiry(std::vector<size_t>& rows) const;
+
+		/*Reorder queries. The store keeps the set of products that have fewer units on hand than they need, and the
+		sum of their shortfalls, up to date as quantities change, so these queries take time proportional to the
+		number of products they report, not to the size of the store.*/
+		//This query returns the number of units a product needs beyond those on hand (zero if it needs none).
+		long long shortfall(size_t row) const;
+		//This query returns the number of products that need more units than they have on hand.
+		size_t reorderCount() const;
+		//This query returns the sum of the shortfalls of all products.
+		long long total_shortfall() const;
+		/*This query appends to rows the rows of the products that need more units than they have on hand: in no
+		particular order, or largest shortfall first (rows with equal shortfalls in row order) if largestFirst is true.*/
+		void reorder(std::vector<size_t>& rows, bool largestFirst = false) const;
+
+		/*Name queries. These read the name index (see NameIndex), which orders the names as strcmp does, like
+		Product::operator>, without comparing every pair: they take a logarithmic search plus time proportional to the
+		number of products they report, and to the number of names changed since the index was last merged. Products
+		with the same name are reported in a fixed but unspecified order; products without a name come first.*/
+		//This query appends to rows the rows of every product, in order of name.
+		void byName(std::vector<size_t>& rows) const;
+		//This query appends to rows the rows of the products with the given name.
+		void findName(const char* name, std::vector<size_t>& rows) const;
+		//This query appends to rows the rows of the products whose names start with prefix, in order of name.
+		void nameStarting(const char* prefix, std::vector<size_t>& rows) const;
+		//This modifier merges the names changed since the last merge into the sorted name index; calling it after a
+		//batch of renames or inserts keeps the name queries logarithmic.
+		void sortNames();
+
+		/*Substring queries. Until indexSubstrings is called these check the name of every product with strstr. From
+		then on the store keeps a trigram index of the names (see TrigramIndex) up to date as products are inserted,
+		renamed and erased, and only the products whose names hold every trigram of the fragments are checked. The
+		rows are reported in ascending order.*/
+		//This modifier builds the substring index of the names.
+		void indexSubstrings();
+		//This query appends to rows the rows of the products whose names contain the fragment.
+		void nameContaining(const char* fragment, std::vector<size_t>& rows) const;
+		//This query appends to rows the rows of the products whose names contain every one of the fragments.
+		void nameContaining(const char* const* fragments, size_t count, std::vector<size_t>& rows) const;
+	};
+}
+#endif // !GMS_InventoryStore_H
@@ -0,0 +1,560 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#include <cstdio>
+#include <cstring>
+#include "Journal.h"
+#include "MappedFile.h"
+#include "MappedLoader.h"
+#include "ProductRecord.h"
+#include "RecordWriter.h"
+
+namespace GMS {
+
+	//the header of a journal file
+	struct JournalHeader {
+		char magic[4];
+		unsigned int version;
+	};
+
+	//the header of an update record, followed by the sku and the payload
+	struct UpdateHeader {
+		unsigned char op;
+		unsigned char sku_length;
+		unsigned short payload_length;
+		unsigned int checksum;
+	};
+
+	//the payload of a receive record
+	struct ReceivePayload {
+		int units;
+		int quantity;
+	};
+
+	//the payload of an add record, followed by the unit and the name; the fields are ordered so that the struct has
+	//no padding
+	struct AddPayload {
+		double price;
+		int quantity;
+		int needed;
+		unsigned short year;
+		unsigned char month;
+		unsigned char day;
+		char type;
+		unsigned char taxed;
+		unsigned char unit_length;
+		unsigned char reserved;
+	};
+
+	static_assert(sizeof(JournalHeader) == 8, "journal header must be 8 bytes");
+	static_assert(sizeof(UpdateHeader) == 8, "update record header must be 8 bytes");
+	static_assert(sizeof(AddPayload) == 24, "add payload must be 24 bytes");
+
+	static const char journal_magic[4] = { 'G', 'M', 'S', 'J' };
+
+	//the update operations
+	enum : unsigned char { op_receive = 1, op_quantity, op_price, op_add, op_erase };
+
+	//the longest payload of a record, which limits the length of the name of an added product
+	static const size_t max_payload_length = 0xFFFF;
+	static_assert(journal_max_name_length == max_payload_length - sizeof(AddPayload) - max_unit_length,
+		"journal_max_name_length must leave room for the fields and the unit of an add record");
+
+#ifdef _WIN32
+	static void* const no_file = INVALID_HANDLE_VALUE;
+#else
+	static const int no_file = -1;
+#endif
+
+	//the 32-bit FNV-1a hash of a block of bytes, continuing from hash
+	static unsigned int fnv(unsigned int hash, const void* data, size_t length)
+	{
+		const unsigned char* p = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < length; ++i)
+			hash = (hash ^ p[i]) * 16777619u;
+		return hash;
+	}
+
+	//returns the checksum of a record from its header (whose checksum field is ignored), sku and payload
+	static unsigned int checksum(UpdateHeader header, const char* sku, const char* payload)
+	{
+		header.checksum = 0;
+		unsigned int hash = fnv(2166136261u, &header, sizeof(header));
+		hash = fnv(hash, sku, header.sku_length);
+		return fnv(hash, payload, header.payload_length);
+	}
+
+	/*applies a single update record to the store. A change to a product that is not in the store (because the record
+	is replayed on top of a product file that already reflects a later removal) is ignored, and so is an add record
+	with an empty sku, which add never writes.*/
+	static void apply(InventoryStore& store, unsigned char op, const char* sku_, size_t skuLength, const char* payload,
+		size_t length)
+	{
+		char sku[max_sku_length + 1];
+		memcpy(sku, sku_, skuLength);
+		sku[skuLength] = '\0';
+		size_t row = store.find(sku);
+
+		if (op == op_add && length >= sizeof(AddPayload)) {
+			if (skuLength == 0)
+				return;
+			AddPayload fields;
+			memcpy(&fields, payload, sizeof(fields));
+			if (fields.unit_length > max_unit_length || sizeof(fields) + fields.unit_length > length)
+				return;
+			char unit[max_unit_length + 1];
+			memcpy(unit, payload + sizeof(fields), fields.unit_length);
+			unit[fields.unit_length] = '\0';
+			const char* name = payload + sizeof(fields) + fields.unit_length;
+			std::string name_(name, payload + length);
+			store.insert(fields.type, sku, name_.c_str(), unit, fields.taxed != 0, fields.price, fields.quantity,
+				fields.needed, fields.year != 0 ? Date(fields.year, fields.month, fields.day) : Date());
+		}
+		else if (row == InventoryStore::npos) {
+			return;
+		}
+		else if (op == op_receive && length == sizeof(ReceivePayload)) {
+			ReceivePayload receipt;
+			memcpy(&receipt, payload, sizeof(receipt));
+			store.quantity(row, receipt.quantity);
+		}
+		else if (op == op_quantity && length == sizeof(int)) {
+			int quantity;
+			memcpy(&quantity, payload, sizeof(quantity));
+			store.quantity(row, quantity);
+		}
+		else if (op == op_price && length == sizeof(double)) {
+			double price;
+			memcpy(&price, payload, sizeof(price));
+			store.price(row, price);
+		}
+		else if (op == op_erase) {
+			store.erase(row);
+		}
+	}
+
+	/*replays the journal in [data, data + length) on the store. It returns false if the data does not start with the
+	header of a journal of the current version; otherwise valid receives the number of bytes up to the end of the last
+	complete record with a good checksum (zero if even the header is incomplete).*/
+	static bool replay(const char* data, size_t length, InventoryStore& store, size_t& valid)
+	{
+		valid = 0;
+		if (length < sizeof(JournalHeader))
+			return length == 0 || memcmp(data, journal_magic, length < 4 ? length : 4) == 0;
+		JournalHeader header;
+		memcpy(&header, data, sizeof(header));
+		if (memcmp(header.magic, journal_magic, sizeof(header.magic)) != 0 || header.version != journal_version)
+			return false;
+
+		size_t offset = sizeof(JournalHeader);
+		while (length - offset >= sizeof(UpdateHeader)) {
+			UpdateHeader update;
+			memcpy(&update, data + offset, sizeof(update));
+			size_t size = sizeof(update) + update.sku_length + update.payload_length;
+			if (update.sku_length > max_sku_length || size > length - offset)
+				break;
+			const char* sku = data + offset + sizeof(update);
+			const char* payload = sku + update.sku_length;
+			if (checksum(update, sku, payload) != update.checksum)
+				break;
+			apply(store, update.op, sku, update.sku_length, payload, update.payload_length);
+			offset += size;
+		}
+		valid = offset;
+		return true;
+	}
+
+	//replays the named journal file on the store; a missing file is an empty journal
+	static bool replay(const char* filename, InventoryStore& store, size_t& valid)
+	{
+		MappedFile file;
+		valid = 0;
+		if (!file.open(filename))
+			return true;
+		return replay(file.data(), file.size(), store, valid);
+	}
+
+	//loads the named product file into the store, copying the names, so that the file is not kept mapped
+	static bool load(const char* filename, InventoryStore& store)
+	{
+		MappedFile file;
+		if (!file.open(filename))
+			return false;
+		const char* cursor = file.data();
+		const char* last = cursor + file.size();
+		ProductRecord record;
+		while (ProductRecord::next(cursor, last)) {
+			if (record.parse(cursor, last))
+				store.insert(record);
+		}
+		return true;
+	}
+
+	//returns true if the named file exists
+	static bool exists(const char* filename)
+	{
+#ifdef _WIN32
+		return GetFileAttributesA(filename) != INVALID_FILE_ATTRIBUTES;
+#else
+		return access(filename, F_OK) == 0;
+#endif
+	}
+
+	//renames a file, replacing the target if it exists
+	static bool replace(const char* from, const char* to)
+	{
+#ifdef _WIN32
+		return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+		return rename(from, to) == 0;
+#endif
+	}
+
+	//forces the directory entries of the directory holding the named file to disk (renames and new files); Windows
+	//makes them durable with MOVEFILE_WRITE_THROUGH instead
+	static void syncDirectory(const std::string& filename)
+	{
+#ifndef _WIN32
+		size_t slash = filename.rfind('/');
+		std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : filename.substr(0, slash);
+		int handle = ::open(directory.c_str(), O_RDONLY);
+		if (handle >= 0) {
+			fsync(handle);
+			::close(handle);
+		}
+#else
+		(void)filename;
+#endif
+	}
+
+	/*folds the old journal of the product file into the product file: loads the product file and replays the old
+	journal into a store of its own, saves it under a temporary name, renames it over the product file and removes
+	the old journal. The store borrows its names from the mapped product file, which it releases before the rename.*/
+	static bool fold(const std::string& base)
+	{
+		std::string old = base + ".journal.old";
+		std::string temporary = base + ".compact";
+		{
+			InventoryStore store;
+			size_t valid;
+			if (!loadMapped(base.c_str(), store) || !replay(old.c_str(), store, valid))
+				return false;
+			if (!saveRecords(temporary.c_str(), store))
+				return false;
+		}
+		if (!replace(temporary.c_str(), base.c_str()))
+			return false;
+		syncDirectory(base);
+		return remove(old.c_str()) == 0;
+	}
+
+	//This constructor creates a closed journal for the referenced store, committing every group records.
+	Journal::Journal(InventoryStore & store, size_t group_) : inventory(store), group(group_ != 0 ? group_ : 1),
+		pending_records(0), journal_size(0), failed(false), compacted(true), file(no_file)
+	{
+	}
+
+	//The destructor commits the pending records, waits for the compaction, if any, and closes the journal.
+	Journal::~Journal()
+	{
+		close();
+	}
+
+	/*opens the journal file, keeping its first valid bytes and writing a new header if there are fewer than a header,
+	and positions it for appending*/
+	bool Journal::openFile(size_t valid)
+	{
+		std::string filename = base + ".journal";
+		bool fresh = valid < sizeof(JournalHeader);
+		if (fresh)
+			valid = 0;
+#ifdef _WIN32
+		file = CreateFileA(filename.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		LARGE_INTEGER position;
+		position.QuadPart = (LONGLONG)valid;
+		if (file != no_file && (!SetFilePointerEx(file, position, nullptr, FILE_BEGIN) || !SetEndOfFile(file)))
+			closeFile();
+#else
+		file = ::open(filename.c_str(), O_WRONLY | O_CREAT, 0666);
+		if (file != no_file && (ftruncate(file, (off_t)valid) != 0 || lseek(file, (off_t)valid, SEEK_SET) < 0))
+			closeFile();
+#endif
+		if (file == no_file)
+			return false;
+		journal_size = valid;
+		if (fresh) {
+			JournalHeader header;
+			memcpy(header.magic, journal_magic, sizeof(header.magic));
+			header.version = journal_version;
+			pending.insert(pending.begin(), reinterpret_cast<const char*>(&header),
+				reinterpret_cast<const char*>(&header) + sizeof(header));
+			journal_size += sizeof(header);
+			if (!commit())
+				return false;
+			syncDirectory(filename);
+		}
+		return true;
+	}
+
+	void Journal::closeFile()
+	{
+		if (file == no_file)
+			return;
+#ifdef _WIN32
+		CloseHandle(file);
+#else
+		::close(file);
+#endif
+		file = no_file;
+	}
+
+	//waits for the background compaction, if any, and returns its result
+	bool Journal::join()
+	{
+		if (compaction.joinable())
+			compaction.join();
+		return compacted;
+	}
+
+	//This modifier loads the product file, replays its journals on top of it and opens the journal for appending.
+	bool Journal::open(const char * filename)
+	{
+		close();
+		base = filename;
+		pending.clear();
+		pending_records = 0;
+		failed = false;
+		compacted = true;
+
+		//a new catalog starts with an empty product file, so that compaction always has a file to fold into
+		inventory.clear();
+		if (!exists(filename)) {
+			if (!saveRecords(filename, inventory))
+				return false;
+			syncDirectory(base);
+		}
+		if (!load(filename, inventory))
+			return false;
+
+		//the old journal is left by a compaction that did not finish: replay it first, and finish folding it
+		std::string old = base + ".journal.old";
+		size_t valid;
+		bool unfolded = exists(old.c_str());
+		if (unfolded && !replay(old.c_str(), inventory, valid))
+			return false;
+		if (!replay((base + ".journal").c_str(), inventory, valid) || !openFile(valid))
+			return false;
+		if (unfolded) {
+			compacted = false;
+			compaction = std::thread([this]() { compacted = fold(base); });
+		}
+		return true;
+	}
+
+	//appends a record to the pending records, committing them if there are as many as the group size
+	void Journal::append(unsigned char op, const char * sku, const void * payload, size_t length)
+	{
+		UpdateHeader header;
+		header.op = op;
+		header.sku_length = (unsigned char)strlen(sku);
+		header.payload_length = (unsigned short)length;
+		header.checksum = checksum(header, sku, static_cast<const char*>(payload));
+
+		const char* bytes = reinterpret_cast<const char*>(&header);
+		pending.insert(pending.end(), bytes, bytes + sizeof(header));
+		pending.insert(pending.end(), sku, sku + header.sku_length);
+		pending.insert(pending.end(), static_cast<const char*>(payload), static_cast<const char*>(payload) + length);
+		journal_size += sizeof(header) + header.sku_length + length;
+		if (++pending_records >= group)
+			commit();
+	}
+
+	//appends an add record holding every field of the row
+	void Journal::appendRow(size_t row)
+	{
+		AddPayload fields;
+		int year, month, day;
+		inventory.expiry(row).extract(year, month, day);
+		fields.price = inventory.price(row);
+		fields.quantity = inventory.quantity(row);
+		fields.needed = inventory.qtyNeeded(row);
+		fields.year = (unsigned short)year;
+		fields.month = (unsigned char)month;
+		fields.day = (unsigned char)day;
+		fields.type = inventory.type(row);
+		fields.taxed = inventory.taxed(row) ? 1 : 0;
+		fields.unit_length = (unsigned char)strlen(inventory.unit(row));
+		fields.reserved = 0;
+
+		const char* name = inventory.name(row);
+		size_t nameLength = name != nullptr ? strlen(name) : 0;
+		std::vector<char> payload(sizeof(fields) + fields.unit_length + nameLength);
+		memcpy(payload.data(), &fields, sizeof(fields));
+		memcpy(payload.data() + sizeof(fields), inventory.unit(row), fields.unit_length);
+		if (nameLength != 0)
+			memcpy(payload.data() + sizeof(fields) + fields.unit_length, name, nameLength);
+		append(op_add, inventory.sku(row), payload.data(), payload.size());
+	}
+
+	bool Journal::receive(const char * sku, int units)
+	{
+		size_t row = inventory.find(sku);
+		if (file == no_file || row == InventoryStore::npos)
+			return false;
+		ReceivePayload receipt;
+		receipt.units = units;
+		receipt.quantity = inventory.receive(row, units);
+		append(op_receive, sku, &receipt, sizeof(receipt));
+		return true;
+	}
+
+	bool Journal::quantity(const char * sku, int qtyOnHand)
+	{
+		size_t row = inventory.find(sku);
+		if (file == no_file || row == InventoryStore::npos)
+			return false;
+		inventory.quantity(row, qtyOnHand);
+		append(op_quantity, sku, &qtyOnHand, sizeof(qtyOnHand));
+		return true;
+	}
+
+	bool Journal::price(const char * sku, double price)
+	{
+		size_t row = inventory.find(sku);
+		if (file == no_file || row == InventoryStore::npos)
+			return false;
+		inventory.price(row, price);
+		append(op_price, sku, &price, sizeof(price));
+		return true;
+	}
+
+	bool Journal::erase(const char * sku)
+	{
+		size_t row = inventory.find(sku);
+		if (file == no_file || row == InventoryStore::npos)
+			return false;
+		inventory.erase(row);
+		append(op_erase, sku, nullptr, 0);
+		return true;
+	}
+
+	//returns true if an add record can hold the product: it has a sku and its name fits in the payload
+	static bool journalable(const iProduct& product)
+	{
+		const char* name = product.name();
+		return !(product == "") && (name == nullptr || strlen(name) <= journal_max_name_length);
+	}
+
+	bool Journal::add(const Product & product)
+	{
+		if (file == no_file || !journalable(product))
+			return false;
+		appendRow(inventory.insert(product));
+		return true;
+	}
+
+	bool Journal::add(const Perishable & product)
+	{
+		if (file == no_file || !journalable(product))
+			return false;
+		appendRow(inventory.insert(product));
+		return true;
+	}
+
+	//This modifier appends the pending records to the journal file in a single write and forces it to disk.
+	bool Journal::commit()
+	{
+		if (file == no_file)
+			return false;
+		const char* p = pending.data();
+		size_t left = pending.size();
+		while (!failed && left != 0) {
+#ifdef _WIN32
+			DWORD count = 0;
+			DWORD chunk = left > 0x40000000 ? 0x40000000 : (DWORD)left;
+			if (!WriteFile(file, p, chunk, &count, nullptr) || count == 0)
+				failed = true;
+#else
+			ssize_t count = ::write(file, p, left);
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count <= 0)
+				failed = true;
+#endif
+			if (!failed) {
+				p += count;
+				left -= (size_t)count;
+			}
+		}
+		if (!failed && !pending.empty()) {
+#ifdef _WIN32
+			failed = !FlushFileBuffers(file);
+#else
+			while (fdatasync(file) != 0) {
+				if (errno != EINTR) {
+					failed = true;
+					break;
+				}
+			}
+#endif
+		}
+		pending.clear();
+		pending_records = 0;
+		return !failed;
+	}
+
+	//This modifier commits the pending records, rotates the journal and folds the old one in the background.
+	bool Journal::compact()
+	{
+		if (file == no_file || !commit())
+			return false;
+		std::string journal = base + ".journal";
+		std::string old = journal + ".old";
+		//an old journal left by a failed fold still holds committed records: fold it before it can be replaced
+		if (!join() || exists(old.c_str())) {
+			compacted = fold(base);
+			if (!compacted)
+				return false;
+		}
+		closeFile();
+		if (!replace(journal.c_str(), old.c_str())) {
+			openFile((size_t)journal_size);
+			return false;
+		}
+		if (!openFile(0)) {
+			failed = true;
+			return false;
+		}
+		compacted = false;
+		compaction = std::thread([this]() { compacted = fold(base); });
+		return true;
+	}
+
+	bool Journal::wait()
+	{
+		return join();
+	}
+
+	bool Journal::close()
+	{
+		bool committed = file == no_file || commit();
+		bool folded = join();
+		closeFile();
+		return committed && folded;
+	}
+
+	size_t Journal::uncommitted() const
+	{
+		return pending_records;
+	}
+
+	unsigned long long Journal::size() const
+	{
+		return journal_size;
+	}
+}
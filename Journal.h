@@ -0,0 +1,138 @@
+//The Journal class makes single product changes durable by appending them to a journal file next to the product file,
+//instead of rewriting the whole product file.
+
+#ifndef GMS_Journal_H
+#define GMS_Journal_H
+
+#include <string>
+#include <vector>
+#include <thread>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	//the version written in the header of a journal file; a journal of any other version is not replayed
+	const unsigned journal_version = 1;
+
+	//the longest name of a product that add can journal: an add record holds every field of the product in a payload
+	//of at most 65535 bytes, 24 of them taken by the numeric fields and up to max_unit_length by the unit
+	const size_t journal_max_name_length = 0xFFFF - 24 - max_unit_length;
+
+	/*A journal belongs to a product file (for example "products.txt") and to the InventoryStore that holds the catalog.
+	Every change made through the journal is applied to the store and recorded as a small binary update record:
+
+		an 8-byte header: the operation, the length of the sku, the length of the payload and a 32-bit checksum of
+		  the rest of the record
+		the sku
+		the payload: the units received and the resulting quantity on hand, the new quantity, the new price (the exact
+		  bits of the double), or every field of an added product; nothing for a removed product
+
+	A record holds the state the change produced rather than the difference it made (a receipt records the resulting
+	quantity as well), so replaying a record twice has the same effect as replaying it once.
+
+	Records are collected in memory and appended to "products.txt.journal" by commit, in a single write followed by a
+	single fsync: that is the group commit. A change is durable once a commit that follows it returns true. commit is
+	called automatically whenever the number of pending records reaches the group size given to the constructor.
+
+	open recovers the catalog: it loads the product file into the store and replays the journal on top of it. The
+	replay stops at the first incomplete or corrupt record (the tail of a write interrupted by a crash), and the
+	journal is truncated there, so that new records are appended after the last good one.
+
+	compact folds the journal back into the product file on a background thread. The current journal is renamed to
+	"products.txt.journal.old" and a new, empty journal takes its place; the background thread loads the product file
+	into a store of its own, replays the old journal, saves the result to "products.txt.compact" with a RecordWriter
+	and renames it over the product file, then removes the old journal. Changes keep being journaled (and committed)
+	while it runs. If the process stops before it finishes, open replays the old journal before the new one; because
+	the records can be replayed twice, it does not matter whether the product file had already been replaced.
+
+	The store must not be changed other than through the journal while the journal is open. A journal is not safe for
+	concurrent use: calls must be serialized by the caller (the background compaction never touches the store).*/
+	class Journal {
+
+		InventoryStore& inventory;
+		std::string base;
+		size_t group;
+		std::vector<char> pending;
+		size_t pending_records;
+		unsigned long long journal_size;
+		bool failed;
+		std::thread compaction;
+		bool compacted;
+#ifdef _WIN32
+		void* file;
+#else
+		int file;
+#endif
+
+		//appends a record to the pending records, committing them if there are as many as the group size
+		void append(unsigned char op, const char* sku, const void* payload, size_t length);
+		//appends an add record holding every field of the row
+		void appendRow(size_t row);
+		//opens the journal file for appending after its first valid bytes, writing a new header if it has none
+		bool openFile(size_t valid);
+		//closes the journal file
+		void closeFile();
+		//waits for the background compaction, if any, and returns its result (true if there was none)
+		bool join();
+
+	public:
+
+		//the number of pending records that triggers a commit when none is given
+		static const size_t default_group = 64;
+
+		//This constructor creates a closed journal for the referenced store, committing every group records.
+		explicit Journal(InventoryStore& store, size_t group = default_group);
+		Journal(const Journal&) = delete;
+		Journal& operator=(const Journal&) = delete;
+
+		//The destructor commits the pending records, waits for the compaction, if any, and closes the journal.
+		~Journal();
+
+		/*This modifier replaces the contents of the store with the named product file (an empty store if the file does
+		not exist) and the changes of its journal, and opens the journal for appending. It returns false if the journal
+		cannot be opened or is not a journal of a supported version; the store is then left with whatever was loaded.*/
+		bool open(const char* filename);
+
+		/*These modifiers change the product with the given sku in the store and journal the change. They return false,
+		and journal nothing, if the journal is not open or if no product has the sku. receive adds a positive number of
+		units to the quantity on hand (like InventoryStore::receive, a non-positive number changes nothing).*/
+		bool receive(const char* sku, int units);
+		bool quantity(const char* sku, int qtyOnHand);
+		bool price(const char* sku, double price);
+		bool erase(const char* sku);
+
+		/*These modifiers insert a copy of the product into the store (replacing the product with the same sku, if any)
+		and journal it. They return false, and change and journal nothing, if the journal is not open, if the product
+		has an empty sku (which a replay could not find again) or if its name is longer than journal_max_name_length.*/
+		bool add(const Product& product);
+		bool add(const Perishable& product);
+
+		/*This modifier appends the pending records to the journal file and forces it to disk. It returns true if every
+		record journaled so far is durable; once a write fails, every later commit returns false.*/
+		bool commit();
+
+		/*This modifier commits the pending records and starts folding the journal into the product file in the
+		background, after waiting for the previous compaction, if any. If the previous compaction failed, its old journal
+		is folded again first, on the calling thread, and the journal is not rotated unless that succeeds: the old
+		journal is never replaced while it holds records that are not in the product file. It returns false if the
+		journal could not be committed, the old journal could not be folded or the journal could not be rotated.*/
+		bool compact();
+
+		//This modifier waits for the background compaction, if any, and returns true if it succeeded.
+		bool wait();
+
+		//This modifier commits the pending records, waits for the compaction, if any, and closes the journal.
+		bool close();
+
+		//This query returns the number of records not committed yet.
+		size_t uncommitted() const;
+
+		//This query returns the size in bytes of the journal since it was last rotated by compact, pending records
+		//included.
+		unsigned long long size() const;
+	};
+}
+#endif // !GMS_Journal_H
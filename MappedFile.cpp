@@ -0,0 +1,111 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "MappedFile.h"
+
+namespace GMS {
+
+	//This constructor creates an object that maps no file.
+	MappedFile::MappedFile()
+	{
+		base = nullptr;
+		length = 0;
+#ifdef _WIN32
+		file = nullptr;
+		mapping = nullptr;
+#endif
+	}
+
+	//This destructor unmaps the file.
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	/*This modifier maps the named file, replacing any file previously mapped, and returns true on success.*/
+	bool MappedFile::open(const char * filename)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE handle = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (handle == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(handle, &fileSize)) {
+			CloseHandle(handle);
+			return false;
+		}
+		file = handle;
+		if (fileSize.QuadPart == 0)
+			return true;
+		mapping = CreateFileMappingA(handle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+		if (mapping != nullptr)
+			base = static_cast<char*>(MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0));
+		if (base == nullptr) {
+			close();
+			return false;
+		}
+		length = (size_t)fileSize.QuadPart;
+		return true;
+#else
+		int fd = ::open(filename, O_RDONLY);
+		if (fd < 0)
+			return false;
+		struct stat info;
+		if (fstat(fd, &info) != 0) {
+			::close(fd);
+			return false;
+		}
+		if (info.st_size > 0) {
+			void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+			if (address == MAP_FAILED) {
+				::close(fd);
+				return false;
+			}
+			base = static_cast<char*>(address);
+			length = (size_t)info.st_size;
+			madvise(address, length, MADV_SEQUENTIAL);
+		}
+		//the mapping stays valid once the descriptor is closed
+		::close(fd);
+		return true;
+#endif
+	}
+
+	//This modifier unmaps the file, if any.
+	void MappedFile::close()
+	{
+#ifdef _WIN32
+		if (base != nullptr)
+			UnmapViewOfFile(base);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != nullptr)
+			CloseHandle(file);
+		mapping = nullptr;
+		file = nullptr;
+#else
+		if (base != nullptr)
+			munmap(base, length);
+#endif
+		base = nullptr;
+		length = 0;
+	}
+
+	char * MappedFile::data() const
+	{
+		return base;
+	}
+
+	size_t MappedFile::size() const
+	{
+		return length;
+	}
+}
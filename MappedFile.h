@@ -0,0 +1,46 @@
+//The MappedFile class maps the contents of a file into memory.
+
+#ifndef GMS_MappedFile_H
+#define GMS_MappedFile_H
+
+#include <cstddef>
+
+namespace GMS {
+
+	/*The mapping is private (copy-on-write): the contents can be modified in memory, for example to terminate the fields
+	of a record in place, without the changes ever reaching the file. Only the pages actually written are copied by the
+	operating system.*/
+	class MappedFile {
+
+		char* base;
+		size_t length;
+#ifdef _WIN32
+		void* file;
+		void* mapping;
+#endif
+
+	public:
+
+		//This constructor creates an object that maps no file.
+		MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		//This destructor unmaps the file.
+		~MappedFile();
+
+		/*This modifier maps the named file, replacing any file previously mapped, and returns true on success. An empty
+		file is mapped successfully with a size of zero.*/
+		bool open(const char* filename);
+
+		//This modifier unmaps the file, if any.
+		void close();
+
+		//This query returns the address of the first byte of the mapping (nullptr if the mapping is empty).
+		char* data() const;
+
+		//This query returns the number of bytes in the mapping.
+		size_t size() const;
+	};
+}
+#endif // !GMS_MappedFile_H
@@ -0,0 +1,298 @@
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstring>
+#include "MappedLoader.h"
+#include "MappedFile.h"
+#include "ProductRecord.h"
+
+namespace GMS {
+
+	/*This function maps the named product file and parses its records in place, inserting them into the store.*/
+	bool loadMapped(const char * filename, InventoryStore & store, LoadStats * stats)
+	{
+		std::unique_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(filename))
+			return false;
+
+		LoadStats counts = { 0, 0 };
+		const char* cursor = file->data();
+		const char* last = cursor + file->size();
+		ProductRecord record;
+		while (ProductRecord::next(cursor, last)) {
+			if (record.parse(cursor, last)) {
+				//the character after the name is its field separator: terminate the name in place
+				file->data()[record.name + record.name_length - file->data()] = '\0';
+				store.insertBorrowed(record);
+				++counts.records;
+			}
+			else {
+				++counts.rejected;
+			}
+		}
+		store.attach(std::move(file));
+
+		if (stats != nullptr)
+			*stats = counts;
+		return true;
+	}
+
+	/*This function maps the named product file and appends one new Product or Perishable per record to the vector.*/
+	bool loadMapped(const char * filename, std::vector<iProduct*>& products, LoadStats * stats)
+	{
+		MappedFile file;
+		if (!file.open(filename))
+			return false;
+
+		LoadStats counts = { 0, 0 };
+		const char* cursor = file.data();
+		const char* last = cursor + file.size();
+		ProductRecord record;
+		while (ProductRecord::next(cursor, last)) {
+			if (record.parse(cursor, last)) {
+				products.push_back(record.create());
+				++counts.records;
+			}
+			else {
+				++counts.rejected;
+			}
+		}
+
+		if (stats != nullptr)
+			*stats = counts;
+		return true;
+	}
+
+	//each worker parses this many chunks on average, so that merging the first chunks overlaps parsing the last ones
+	static const unsigned chunks_per_thread = 4;
+
+	//returns the number of threads to use for a requested count, zero meaning every hardware thread
+	static unsigned workerCount(unsigned threads)
+	{
+		if (threads == 0)
+			threads = std::thread::hardware_concurrency();
+		return threads != 0 ? threads : 1;
+	}
+
+	//calls f(i) for every i in [0, count) on the given number of threads (the calling thread included)
+	template <typename Function>
+	static void parallelFor(size_t count, unsigned threads, Function f)
+	{
+		std::atomic<size_t> next(0);
+		auto work = [&]() {
+			size_t i;
+			while ((i = next++) < count)
+				f(i);
+		};
+		std::vector<std::thread> workers;
+		for (unsigned t = 1; t < threads && t < count; ++t)
+			workers.push_back(std::thread(work));
+		work();
+		for (size_t t = 0; t < workers.size(); ++t)
+			workers[t].join();
+	}
+
+	//A ParallelParse splits a mapped file into chunks and parses them on worker threads.
+	class ParallelParse {
+
+		struct Chunk {
+			const char* first;
+			const char* last;
+			std::vector<ProductRecord> records;
+			size_t rejected;
+			bool done;
+		};
+
+		std::vector<Chunk> chunks;
+		std::vector<std::thread> workers;
+		std::atomic<size_t> next_chunk;
+		std::mutex lock;
+		std::condition_variable parsed;
+
+		//parses chunks until none is left; names are terminated in place if the mapping is writable
+		void work(bool terminate)
+		{
+			size_t i;
+			while ((i = next_chunk++) < chunks.size()) {
+				Chunk& chunk = chunks[i];
+				const char* cursor = chunk.first;
+				ProductRecord record;
+				size_t rejected = 0;
+				chunk.records.reserve((size_t)(chunk.last - chunk.first) / 48 + 1);
+				while (ProductRecord::next(cursor, chunk.last)) {
+					if (record.parse(cursor, chunk.last)) {
+						if (terminate)
+							const_cast<char*>(record.name)[record.name_length] = '\0';
+						chunk.records.push_back(record);
+					}
+					else {
+						++rejected;
+					}
+				}
+				std::lock_guard<std::mutex> guard(lock);
+				chunk.rejected = rejected;
+				chunk.done = true;
+				parsed.notify_all();
+			}
+		}
+
+	public:
+
+		//splits [first, last) into chunks on newline boundaries and starts the workers
+		ParallelParse(char* first, char* last, unsigned threads, bool terminate) : next_chunk(0)
+		{
+			threads = workerCount(threads);
+			size_t target = (size_t)(last - first) / (threads * chunks_per_thread) + 1;
+			const char* cursor = first;
+			while (cursor != last) {
+				const char* end = (size_t)(last - cursor) > target ? cursor + target : last;
+				if (end != last) {
+					const char* newline = static_cast<const char*>(memchr(end, '\n', (size_t)(last - end)));
+					end = newline != nullptr ? newline + 1 : last;
+				}
+				Chunk chunk = { cursor, end, std::vector<ProductRecord>(), 0, false };
+				chunks.push_back(chunk);
+				cursor = end;
+			}
+			for (unsigned t = 0; t < threads && t < chunks.size(); ++t)
+				workers.push_back(std::thread(&ParallelParse::work, this, terminate));
+		}
+
+		ParallelParse(const ParallelParse&) = delete;
+		ParallelParse& operator=(const ParallelParse&) = delete;
+
+		~ParallelParse()
+		{
+			for (size_t t = 0; t < workers.size(); ++t)
+				workers[t].join();
+		}
+
+		size_t size() const
+		{
+			return chunks.size();
+		}
+
+		//waits until chunk i is parsed and returns its records; the caller releases them once merged
+		std::vector<ProductRecord>& wait(size_t i, size_t& rejected)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			parsed.wait(guard, [&] { return chunks[i].done; });
+			rejected = chunks[i].rejected;
+			return chunks[i].records;
+		}
+
+		//drops every chunk once they have all been merged
+		void release()
+		{
+			for (size_t t = 0; t < workers.size(); ++t)
+				workers[t].join();
+			workers.clear();
+			chunks.clear();
+		}
+	};
+
+	/*fills an empty store with every parsed chunk: once all of them are parsed, the rows are appended at once, each
+	chunk is copied into its own rows on its own thread and every index is built in a single pass. That is the file
+	order result only if no sku repeats, which the sku index shows afterwards; if one does, the store is emptied again
+	and the function returns false, leaving the chunks to be merged in order.*/
+	static bool fillColumns(ParallelParse& parse, InventoryStore& store, unsigned threads, LoadStats& counts)
+	{
+		std::vector<size_t> firsts(parse.size());
+		size_t total = 0;
+		for (size_t i = 0; i < parse.size(); ++i) {
+			size_t rejected = 0;
+			firsts[i] = total;
+			total += parse.wait(i, rejected).size();
+		}
+		size_t first = store.extend(total);
+		parallelFor(parse.size(), threads, [&](size_t i) {
+			size_t rejected = 0;
+			const std::vector<ProductRecord>& records = parse.wait(i, rejected);
+			for (size_t r = 0; r < records.size(); ++r)
+				store.fill(first + firsts[i] + r, records[r]);
+		});
+		store.reindex();
+
+		std::atomic<bool> unique(true);
+		parallelFor(parse.size(), threads, [&](size_t i) {
+			size_t rejected = 0;
+			const std::vector<ProductRecord>& records = parse.wait(i, rejected);
+			for (size_t r = 0; r < records.size() && unique; ++r) {
+				if (store.find(records[r].sku) != first + firsts[i] + r)
+					unique = false;
+			}
+		});
+		if (!unique) {
+			store.clear();
+			return false;
+		}
+		for (size_t i = 0; i < parse.size(); ++i) {
+			size_t rejected = 0;
+			counts.records += parse.wait(i, rejected).size();
+			counts.rejected += rejected;
+		}
+		return true;
+	}
+
+	/*This function loads the named product file into the store, parsing it on several threads.*/
+	bool loadParallel(const char * filename, InventoryStore & store, unsigned threads, LoadStats * stats)
+	{
+		std::unique_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(filename))
+			return false;
+
+		LoadStats counts = { 0, 0 };
+		{
+			ParallelParse parse(file->data(), file->data() + file->size(), threads, true);
+			//once an empty store is filled column-wise there is nothing left to merge
+			if (store.size() == 0 && fillColumns(parse, store, workerCount(threads), counts))
+				parse.release();
+			for (size_t i = 0; i < parse.size(); ++i) {
+				size_t rejected = 0;
+				std::vector<ProductRecord>& records = parse.wait(i, rejected);
+				//chunks are of equal size: size the columns and the sku index once, from the first chunk
+				if (i == 0)
+					store.reserve(store.size() + records.size() * parse.size() + parse.size());
+				for (size_t r = 0; r < records.size(); ++r)
+					store.insertBorrowed(records[r]);
+				counts.records += records.size();
+				counts.rejected += rejected;
+				std::vector<ProductRecord>().swap(records);
+			}
+		}
+		store.attach(std::move(file));
+
+		if (stats != nullptr)
+			*stats = counts;
+		return true;
+	}
+
+	/*This function appends one new Product or Perishable per record of the named file to the vector, parsing the
+	file on several threads.*/
+	bool loadParallel(const char * filename, std::vector<iProduct*>& products, unsigned threads, LoadStats * stats)
+	{
+		MappedFile file;
+		if (!file.open(filename))
+			return false;
+
+		LoadStats counts = { 0, 0 };
+		ParallelParse parse(file.data(), file.data() + file.size(), threads, false);
+		for (size_t i = 0; i < parse.size(); ++i) {
+			size_t rejected = 0;
+			std::vector<ProductRecord>& records = parse.wait(i, rejected);
+			if (i == 0)
+				products.reserve(products.size() + records.size() * parse.size() + parse.size());
+			for (size_t r = 0; r < records.size(); ++r)
+				products.push_back(records[r].create());
+			counts.records += records.size();
+			counts.rejected += rejected;
+			std::vector<ProductRecord>().swap(records);
+		}
+
+		if (stats != nullptr)
+			*stats = counts;
+		return true;
+	}
+}
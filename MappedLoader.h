@@ -0,0 +1,44 @@
+//The mapped loader reads a product file through a memory mapping instead of an fstream.
+
+#ifndef GMS_MappedLoader_H
+#define GMS_MappedLoader_H
+
+#include <vector>
+#include "iProduct.h"
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	//The number of records accepted and rejected (malformed) by a load.
+	struct LoadStats {
+		size_t records;
+		size_t rejected;
+	};
+
+	/*This function maps the named product file and parses its N and P records in place, inserting them into the
+	store. No name is copied: each record's name field is null-terminated inside the private mapping, which is
+	attached to the store, and the store points straight at it until the name is changed. A record with the sku
+	of a record already in the store replaces it, exactly as if the records were inserted in file order.
+	It returns false if the file cannot be opened; stats, if not nullptr, receives the record counts.*/
+	bool loadMapped(const char* filename, InventoryStore& store, LoadStats* stats = nullptr);
+
+	/*This function maps the named product file and appends one new Product or Perishable per record to the vector,
+	in file order, holding the same data that Product::load and Perishable::load would extract. The caller owns the
+	objects. It returns false if the file cannot be opened; stats, if not nullptr, receives the record counts.*/
+	bool loadMapped(const char* filename, std::vector<iProduct*>& products, LoadStats* stats = nullptr);
+
+	/*These functions load the named product file like loadMapped, but parse it on several threads. The mapping is
+	split into chunks on record (newline) boundaries; worker threads parse the chunks while the calling thread merges
+	the parsed chunks into the store or the vector, strictly in file order. The result is therefore identical to
+	loadMapped, including which record wins when several share a sku (the last one in the file). A thread count of
+	zero uses every hardware thread.
+
+	Loading into an empty store merges in parallel as well: the rows of every chunk are copied into the columns by
+	the worker threads, each chunk into its own range of rows, and the indexes are built once at the end
+	(InventoryStore::extend, fill and reindex). Only the index build is serial. If the file turns out to repeat a
+	sku, the store is emptied and the chunks are merged one record at a time instead.*/
+	bool loadParallel(const char* filename, InventoryStore& store, unsigned threads = 0, LoadStats* stats = nullptr);
+	bool loadParallel(const char* filename, std::vector<iProduct*>& products, unsigned threads = 0,
+		LoadStats* stats = nullptr);
+}
+#endif // !GMS_MappedLoader_H
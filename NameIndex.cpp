@@ -0,0 +1,314 @@
+#include <cstring>
+#include <algorithm>
+#include "NameIndex.h"
+
+namespace GMS {
+
+	//the position of a row without an entry, and the mark of a position in the unsorted entries
+	static const size_t no_entry = static_cast<size_t>(-1);
+	static const size_t unsorted_flag = ~(no_entry >> 1);
+
+	//fewer entries than this are sorted by comparison, as the radix passes would mostly clear their counts
+	static const size_t min_radix = 1024;
+
+	//returns the mask of the bytes of a key that hold the first length characters of a name
+	static unsigned long long prefixMask(size_t length)
+	{
+		return length == 0 ? 0 : length >= 8 ? ~0ULL : ~0ULL << (64 - 8 * length);
+	}
+
+	/*This function packs the first eight characters of a C-style string big-endian into a 64-bit key.*/
+	unsigned long long NameIndex::pack(const char * name)
+	{
+		unsigned long long key = 0;
+		if (name != nullptr) {
+			for (int i = 0; i < 8 && name[i] != '\0'; ++i) {
+				key |= (unsigned long long)(unsigned char)name[i] << (56 - 8 * i);
+			}
+		}
+		return key;
+	}
+
+	//orders two entries by name: equal keys hold the same first eight characters, and unless the last of them is the
+	//terminator the rest of the names decide
+	bool NameIndex::less(const Entry & a, const Entry & b)
+	{
+		if (a.key != b.key)
+			return a.key < b.key;
+		return (a.key & 0xff) != 0 && strcmp(a.name + 8, b.name + 8) < 0;
+	}
+
+	/*This function sorts the entries in name order. A least-significant-digit radix sort orders them by key, one byte
+	per pass; a pass is skipped when every key holds the same value in its byte (as the bytes past the end of short
+	names do). The sort is stable, and only the runs of equal keys of names longer than eight characters are then
+	sorted by the rest of their names.*/
+	void NameIndex::sort(std::vector<Entry>& entries)
+	{
+		const size_t count = entries.size();
+		if (count < min_radix) {
+			std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return less(a, b); });
+			return;
+		}
+		std::vector<size_t> counts(8 * 256, 0);
+		for (const Entry& entry : entries) {
+			for (int digit = 0; digit < 8; ++digit)
+				++counts[digit * 256 + ((entry.key >> (8 * digit)) & 0xff)];
+		}
+		std::vector<Entry> buffer(count);
+		for (int digit = 0; digit < 8; ++digit) {
+			size_t* next = &counts[digit * 256];
+			if (next[(entries[0].key >> (8 * digit)) & 0xff] == count)
+				continue;
+			size_t total = 0;
+			for (int value = 0; value < 256; ++value) {
+				total += next[value];
+				next[value] = total - next[value];
+			}
+			for (const Entry& entry : entries)
+				buffer[next[(entry.key >> (8 * digit)) & 0xff]++] = entry;
+			entries.swap(buffer);
+		}
+		for (size_t first = 0, last; first < count; first = last) {
+			for (last = first + 1; last < count && entries[last].key == entries[first].key; ++last)
+				;
+			if (last - first > 1 && (entries[first].key & 0xff) != 0)
+				std::sort(entries.begin() + first, entries.begin() + last, [](const Entry& a, const Entry& b) {
+					return strcmp(a.name + 8, b.name + 8) < 0;
+				});
+		}
+	}
+
+	//This constructor creates an empty index.
+	NameIndex::NameIndex() : dead(0)
+	{
+	}
+
+	size_t NameIndex::size() const
+	{
+		return sorted.size() - dead + unsorted.size();
+	}
+
+	size_t NameIndex::pending() const
+	{
+		return unsorted.size();
+	}
+
+	void NameIndex::clear()
+	{
+		sorted.clear();
+		unsorted.clear();
+		slots.clear();
+		dead = 0;
+	}
+
+	void NameIndex::reserve(size_t count)
+	{
+		slots.reserve(count);
+	}
+
+	//This modifier replaces the contents of the index with the rows [0, count), sorting them in a single pass.
+	void NameIndex::build(const char * const * names, size_t count)
+	{
+		clear();
+		unsorted.reserve(count);
+		slots.reserve(count);
+		for (size_t row = 0; row < count; ++row) {
+			const char* name = names[row] != nullptr ? names[row] : "";
+			slots.push_back(unsorted_flag | row);
+			unsorted.push_back(Entry{ pack(name), name, row });
+		}
+		merge();
+	}
+
+	NameIndex::Entry & NameIndex::entry(size_t row)
+	{
+		size_t slot = slots[row];
+		return (slot & unsorted_flag) != 0 ? unsorted[slot & ~unsorted_flag] : sorted[slot];
+	}
+
+	//removes the entry of the row: an unsorted entry is replaced with the last one, a sorted entry is marked dead
+	void NameIndex::remove(size_t row)
+	{
+		if (row >= slots.size() || slots[row] == no_entry)
+			return;
+		size_t slot = slots[row];
+		if ((slot & unsorted_flag) != 0) {
+			Entry& removed = unsorted[slot & ~unsorted_flag];
+			removed = unsorted.back();
+			slots[removed.row] = slot;
+			unsorted.pop_back();
+		}
+		else {
+			sorted[slot].row = no_entry;
+			++dead;
+		}
+		slots[row] = no_entry;
+	}
+
+	void NameIndex::tidy()
+	{
+		size_t live = sorted.size() - dead;
+		size_t limit = live / unsorted_fraction > min_unsorted ? live / unsorted_fraction : min_unsorted;
+		if (unsorted.size() > limit || dead > limit)
+			merge();
+	}
+
+	void NameIndex::assign(size_t row, const char * name)
+	{
+		if (name == nullptr)
+			name = "";
+		if (row >= slots.size())
+			slots.resize(row + 1, no_entry);
+		if (slots[row] != no_entry) {
+			Entry& current = entry(row);
+			if (strcmp(current.name, name) == 0) {
+				current.name = name;
+				return;
+			}
+			remove(row);
+		}
+		slots[row] = unsorted_flag | unsorted.size();
+		unsorted.push_back(Entry{ pack(name), name, row });
+		tidy();
+	}
+
+	//This modifier removes the row and moves the entry of the last row into it.
+	void NameIndex::erase(size_t row, size_t last)
+	{
+		remove(row);
+		if (last < slots.size()) {
+			if (last != row && slots[last] != no_entry) {
+				entry(last).row = row;
+				slots[row] = slots[last];
+			}
+			slots.resize(last);
+		}
+		tidy();
+	}
+
+	/*This modifier sorts the unsorted entries on their own and merges them with the live sorted entries into a new
+	array (or makes them the array, if there are no live sorted entries), then records the new position of every row.*/
+	void NameIndex::merge()
+	{
+		if (unsorted.empty() && dead == 0)
+			return;
+		sort(unsorted);
+		if (sorted.size() == dead) {
+			sorted.swap(unsorted);
+		}
+		else {
+			std::vector<Entry> merged;
+			merged.reserve(size());
+			size_t i = 0, j = 0;
+			while (i < sorted.size() || j < unsorted.size()) {
+				if (i < sorted.size() && sorted[i].row == no_entry)
+					++i;
+				else if (j == unsorted.size() || (i < sorted.size() && !less(unsorted[j], sorted[i])))
+					merged.push_back(sorted[i++]);
+				else
+					merged.push_back(unsorted[j++]);
+			}
+			sorted.swap(merged);
+		}
+		unsorted.clear();
+		dead = 0;
+		for (size_t k = 0; k < sorted.size(); ++k)
+			slots[sorted[k].row] = k;
+	}
+
+	//compares the first length characters of the name of the entry with text: negative, zero or positive
+	static int order(unsigned long long entryKey, const char* entryName, unsigned long long key, unsigned long long mask,
+		const char* text, size_t length)
+	{
+		unsigned long long head = entryKey & mask;
+		if (head != key)
+			return head < key ? -1 : 1;
+		return length <= 8 ? 0 : strncmp(entryName + 8, text + 8, length - 8);
+	}
+
+	/*returns the range of sorted whose names start with the first length characters of text, by binary search. The
+	names of dead entries may already be freed, so only their keys are read: the search first narrows the range to
+	the entries whose keys match, which needs no names, and then, if text is longer than a key, searches that range
+	by the rest of the names, reading the first live entry at or after each probe instead of a dead one. Wherever the
+	bounds then fall among dead entries, report skips those.*/
+	void NameIndex::range(const char * text, size_t length, size_t & first, size_t & last) const
+	{
+		unsigned long long mask = prefixMask(length);
+		unsigned long long key = pack(text) & mask;
+		first = std::partition_point(sorted.begin(), sorted.end(), [&](const Entry& entry) {
+			return (entry.key & mask) < key;
+		}) - sorted.begin();
+		last = std::partition_point(sorted.begin() + first, sorted.end(), [&](const Entry& entry) {
+			return (entry.key & mask) == key;
+		}) - sorted.begin();
+		if (length <= 8)
+			return;
+
+		//returns the first position of [low, high) whose live entry compares after the rest of text (or not before
+		//it, if after is false)
+		auto search = [&](size_t low, size_t high, bool after) {
+			while (low < high) {
+				size_t middle = low + (high - low) / 2;
+				size_t probe = middle;
+				while (probe < high && sorted[probe].row == no_entry)
+					++probe;
+				int comparison = probe < high ? strncmp(sorted[probe].name + 8, text + 8, length - 8) : 1;
+				if (comparison < 0 || (after && comparison == 0))
+					low = probe + 1;
+				else
+					high = middle;
+			}
+			return low;
+		};
+		first = search(first, last, false);
+		last = search(first, last, true);
+	}
+
+	//merges the live entries of sorted[first, last) with the matching unsorted entries (sorted first)
+	void NameIndex::report(size_t first, size_t last, const char * text, size_t length, std::vector<size_t>& rows) const
+	{
+		unsigned long long mask = prefixMask(length);
+		unsigned long long key = pack(text) & mask;
+		std::vector<Entry> matches;
+		for (const Entry& entry : unsorted) {
+			if (order(entry.key, entry.name, key, mask, text, length) == 0)
+				matches.push_back(entry);
+		}
+		sort(matches);
+		rows.reserve(rows.size() + (last - first) + matches.size());
+		size_t j = 0;
+		for (size_t i = first; i < last; ++i) {
+			if (sorted[i].row == no_entry)
+				continue;
+			while (j < matches.size() && less(matches[j], sorted[i]))
+				rows.push_back(matches[j++].row);
+			rows.push_back(sorted[i].row);
+		}
+		for (; j < matches.size(); ++j)
+			rows.push_back(matches[j].row);
+	}
+
+	void NameIndex::rows(std::vector<size_t>& rows) const
+	{
+		report(0, sorted.size(), "", 0, rows);
+	}
+
+	//The name is matched with its terminator, so that only names of the same length match.
+	void NameIndex::find(const char * name, std::vector<size_t>& rows) const
+	{
+		if (name == nullptr)
+			name = "";
+		size_t first, last;
+		range(name, strlen(name) + 1, first, last);
+		report(first, last, name, strlen(name) + 1, rows);
+	}
+
+	void NameIndex::prefix(const char * prefix, std::vector<size_t>& rows) const
+	{
+		if (prefix == nullptr)
+			prefix = "";
+		size_t first, last;
+		range(prefix, strlen(prefix), first, last);
+		report(first, last, prefix, strlen(prefix), rows);
+	}
+}
@@ -0,0 +1,109 @@
+//The NameIndex class keeps the rows of a product collection in order of name, for ordered listings, exact lookups
+//and prefix searches that do not compare every name.
+
+#ifndef GMS_NameIndex_H
+#define GMS_NameIndex_H
+
+#include <vector>
+
+namespace GMS {
+
+	/*Every entry of the index holds the first eight characters of a name packed big-endian into a 64-bit key, so that
+	comparing two keys as integers orders the names like strcmp does on those characters; only names that share their
+	first eight characters compare the rest of the characters. The entries are kept in a sorted array, which is built
+	with a radix sort on the keys: no name is compared to another unless they share their first eight characters.
+
+	Changes do not move the sorted array: an erased or renamed row leaves a dead entry behind, and a new or renamed row
+	is added to a list of unsorted entries. Once the unsorted entries (or the dead ones) are more than min_unsorted and
+	more than one in unsorted_fraction of the live sorted entries, the unsorted entries are sorted on their own and
+	merged into the array in a single linear pass, so a change costs constant amortized time. Queries report the
+	unsorted entries as well, at the cost of a scan of the list, which this keeps to a small part of the index: call
+	merge after a batch of changes for queries in logarithmic time.
+
+	Rows with the same name are reported in a fixed but unspecified order. The names are not copied: an address
+	passed to the index must stay valid until the row is renamed or erased, or the index is cleared. The name of a dead
+	entry is never read again (searches order dead entries by their keys only), so it may be freed as soon as its row
+	is renamed or erased.*/
+	class NameIndex {
+
+		struct Entry {
+			unsigned long long key;
+			const char* name;
+			//the row of the entry; npos marks a dead entry of the sorted array
+			size_t row;
+		};
+
+		//the sorted entries and the number of dead entries among them
+		std::vector<Entry> sorted;
+		size_t dead;
+		//the entries added since the last merge, in no particular order
+		std::vector<Entry> unsorted;
+		//for every row, the position of its entry: in sorted, in unsorted (marked with the top bit), or npos
+		std::vector<size_t> slots;
+
+		static bool less(const Entry& a, const Entry& b);
+		//sorts the entries in name order
+		static void sort(std::vector<Entry>& entries);
+		//the entry of the row, which must have one
+		Entry& entry(size_t row);
+		//removes the entry of the row, if it has one
+		void remove(size_t row);
+		//merges if the unsorted or the dead entries have grown past their limits
+		void tidy();
+		//appends the rows of the entries in [first, last) of sorted and of the unsorted entries that start with the
+		//first length characters of text, in name order
+		void report(size_t first, size_t last, const char* text, size_t length, std::vector<size_t>& rows) const;
+		//returns the range of sorted whose names start with the first length characters of text
+		void range(const char* text, size_t length, size_t& first, size_t& last) const;
+
+	public:
+
+		//the position of a row without an entry
+		static const size_t npos = static_cast<size_t>(-1);
+		//the least number of unsorted entries that triggers a merge
+		static const size_t min_unsorted = 4096;
+		//a merge is triggered once the unsorted (or dead) entries exceed this fraction of the live sorted entries
+		static const size_t unsorted_fraction = 8;
+
+		/*This function packs the first eight characters of a C-style string big-endian into a 64-bit key: keys compare
+		as the strings do (as unsigned characters) over those characters. The empty string and nullptr pack to zero.*/
+		static unsigned long long pack(const char* name);
+
+		//This constructor creates an empty index.
+		NameIndex();
+
+		//This query returns the number of rows in the index.
+		size_t size() const;
+
+		//This query returns the number of entries added since the last merge.
+		size_t pending() const;
+
+		//This modifier removes every row from the index.
+		void clear();
+
+		//This modifier reserves room for the given number of rows.
+		void reserve(size_t count);
+
+		//This modifier replaces the contents of the index with the rows [0, count), row i named names[i].
+		void build(const char* const* names, size_t count);
+
+		/*This modifier gives the row the name (nullptr is the empty name), adding the row to the index if it has no
+		entry. Renaming a row to an identical string only replaces the address of its name.*/
+		void assign(size_t row, const char* name);
+
+		/*This modifier removes the row from the index and moves the entry of the last row into it, mirroring
+		InventoryStore::erase; last is the last row of the index (or row itself).*/
+		void erase(size_t row, size_t last);
+
+		//This modifier sorts the unsorted entries into the sorted array and drops the dead entries.
+		void merge();
+
+		//This query appends to rows every row of the index, in order of name.
+		void rows(std::vector<size_t>& rows) const;
+		//This query appends to rows the rows named exactly name.
+		void find(const char* name, std::vector<size_t>& rows) const;
+		//This query appends to rows the rows whose names start with prefix, in order of name.
+		void prefix(const char* prefix, std::vector<size_t>& rows) const;
+	};
+}
+#endif // !GMS_NameIndex_H
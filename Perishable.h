@@ -9,11 +9,16 @@ namespace GMS {
 
 	//Your Perishable class uses a Date object, but does not need its own ErrorState object 
 	//(the Product base class handles all error processing).
-	class Perishable : public Product {
+	class Perishable final : public Product {
 		
 		/*A Date object holds the expiry date for the perishable product.*/
 		Date per_prod_exp_date;
 
+		friend class InventoryStore;
+		friend struct ProductRecord;
+		friend class ReportWriter;
+		friend class RecordWriter;
+
 	public:
 
 		/*No argument Constructor 
@@ -21,6 +26,14 @@ namespace GMS {
 		class constructor and sets the current object to a safe empty state.*/
 		Perishable();
 
+		/*Copy and move operations
+		A Perishable is copied or moved by copying or moving its Product part and its expiry date; moving takes over the
+		dynamic memory of the Product part instead of copying it.*/
+		Perishable(const Perishable& perishable) = default;
+		Perishable(Perishable&& perishable) noexcept = default;
+		Perishable& operator=(const Perishable& perishable) = default;
+		Perishable& operator=(Perishable&& perishable) noexcept = default;
+
 		/*This query receives a reference to an fstream object and an optional bool and returns a reference 
 		to the modified fstream object. This function stores a single file record for the current object. 
 		This function
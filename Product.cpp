@@ -1,6 +1,10 @@
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <utility>
 #include <string>
 #include <sstream>
 #include <fstream>
@@ -10,23 +14,72 @@ using namespace std;
 
 namespace GMS {
 
+	/*A long name lives in a block of dynamic memory that starts with the number of products referring to it and
+	continues with the characters; product_name points at the characters. The count is atomic so that copies of a
+	product may be made and destroyed on different threads.*/
+	struct NameBlock {
+		std::atomic<unsigned int> references;
+	};
+
+	static NameBlock* nameBlock(char* text)
+	{
+		return reinterpret_cast<NameBlock*>(text - sizeof(NameBlock));
+	}
+
+	//This function allocates a block holding a copy of the len characters of name, with one reference.
+	static char* shareName(const char* name, size_t len)
+	{
+		char* memory = new char[sizeof(NameBlock) + len + 1];
+		new (memory) NameBlock{ {1} };
+		char* text = memory + sizeof(NameBlock);
+		memcpy(text, name, len);
+		text[len] = '\0';
+		return text;
+	}
+
+	//This query returns true if product_name points to a shared block of dynamic memory.
+	bool Product::nameAllocated() const
+	{
+		return product_name != nullptr && product_name != inline_name;
+	}
+
+	//This function drops the reference of the object to its shared name block, if any; the last reference frees it.
+	void Product::releaseName()
+	{
+		if (nameAllocated()) {
+			NameBlock* block = nameBlock(product_name);
+			if (block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+				block->~NameBlock();
+				delete[] reinterpret_cast<char*>(block);
+			}
+		}
+		product_name = nullptr;
+	}
+
 	/*This function receives the address of a C - style null - terminated string that holds the name of the product.This function
-	stores the name in dynamically allocated memory
+	stores the name inside the object if it fits in inline_name_length characters, and in a newly allocated shared block otherwise
 	replaces any name previously stored
 	If the incoming parameter holds the nullptr address, this function removes the name of the product, if any, from memory.*/
 	void GMS::Product::name(const char *name)
 	{
 		if (name != nullptr) { 
-			int len = (int)strlen(name);
-				product_name = new char[len + 1];
-			for(int i=0; i < len; ++i){
-				product_name[i] = name[i];
+			size_t len = strlen(name);
+			if (len <= (size_t)inline_name_length) {
+				//memmove: name may already be (part of) inline_name
+				memmove(inline_name, name, len);
+				inline_name[len] = '\0';
+				releaseName();
+				product_name = inline_name;
+			}
+			else {
+				//the copy is made before the old name is released, in case name points into it
+				char* copy = shareName(name, len);
+				releaseName();
+				product_name = copy;
 			}
-			product_name[len] = '\0';
 		}
 		else if (name == nullptr) {
-			delete[] product_name;
-			product_name = nullptr;
+			releaseName();
 		}
 	}
 
@@ -103,11 +156,13 @@ namespace GMS {
 	//7 Argument Constructor
 	Product::Product(const char * sku, const char * pname, const char * unit, int qtyOnHand, bool taxStatus, double priceBeforeTax, int qtyNeeded)
 	{
+		product_type = 'N';
 		strncpy(psku, sku, max_sku_length);
 		psku[max_sku_length] = '\0';
+		product_name = nullptr;
 		name(pname);
 		strncpy(product_unit_descrp, unit, max_unit_length);
-		product_unit_descrp[max_sku_length] = '\0';
+		product_unit_descrp[max_unit_length] = '\0';
 		quantity_on_hand = qtyOnHand;
 		taxable_product = taxStatus;
 		unit_price_before_tax = priceBeforeTax;
@@ -117,8 +172,8 @@ namespace GMS {
 	//Copy Constructor
 	Product::Product(const Product & product)
 	{
+		product_name = nullptr;
 		if (!product.isEmpty()) {
-			product_name = nullptr;
 			*this = product;
 		}
 	}
@@ -129,7 +184,14 @@ namespace GMS {
 		if (this != &product) {
 			product_type = product.product_type;
 			strcpy(psku, product.psku);
-			name(product.product_name);
+			//a long name is shared rather than copied
+			if (product.nameAllocated()) {
+				nameBlock(product.product_name)->references.fetch_add(1, std::memory_order_relaxed);
+				releaseName();
+				product_name = product.product_name;
+			}
+			else
+				name(product.product_name);
 			strcpy(product_unit_descrp, product.product_unit_descrp);
 			quantity_on_hand = product.quantity_on_hand;
 			quantity_needed = product.quantity_needed;
@@ -140,11 +202,52 @@ namespace GMS {
 		return *this;
 	}
 
+	//Move Constructor
+	Product::Product(Product&& product) noexcept
+	{
+		product_name = nullptr;
+		*this = std::move(product);
+	}
+
+	//Move Assignment Operator
+	Product & Product::operator=(Product && product) noexcept
+	{
+		if (this != &product) {
+			product_type = product.product_type;
+			strcpy(psku, product.psku);
+			strcpy(product_unit_descrp, product.product_unit_descrp);
+			quantity_on_hand = product.quantity_on_hand;
+			quantity_needed = product.quantity_needed;
+			taxable_product = product.taxable_product;
+			unit_price_before_tax = product.unit_price_before_tax;
+
+			//a reference to a shared name changes hands; an inline name has to be copied
+			releaseName();
+			if (product.nameAllocated())
+				product_name = product.product_name;
+			else if (product.product_name != nullptr) {
+				strcpy(inline_name, product.inline_name);
+				product_name = inline_name;
+			}
+			else
+				product_name = nullptr;
+			ErrState = std::move(product.ErrState);
+
+			product.product_name = nullptr;
+			product.psku[0] = '\0';
+			product.product_unit_descrp[0] = '\0';
+			product.quantity_on_hand = 0;
+			product.quantity_needed = 0;
+			product.taxable_product = true;
+			product.unit_price_before_tax = 0;
+		}
+		return *this;
+	}
+
 	//Destructor
 	Product::~Product()
 	{
-		delete[] product_name;
-		product_name = nullptr;
+		releaseName();
 	}
 
 	/*This query receives a reference to an fstream object and an optional bool and returns a reference to the fstream object.This function
@@ -161,34 +264,34 @@ namespace GMS {
 
 	/*This modifier receives a reference to an fstream object and returns a reference to that fstream object.This function
 	extracts the fields for a single record from the fstream object
-	creates a temporary object from the extracted field data
-	copy assigns the temporary object to the current object.*/
+	stores the extracted field data directly in the current object, reusing its storage, and clears its error state.
+	The product type is not changed.*/
 	std::fstream & Product::load(std::fstream & file)
 	{
-		//char product_type_;
-		char psku_[max_sku_length+1];
+		//the name needs a buffer of its own only because it may be too long to be stored inline
 		char product_name_[max_name_length+1];
-		char product_unit_descrp_[max_unit_length+1];
-		bool taxable_product_;
-		double unit_price_before_tax_;
-		int quantity_on_hand_;
-		int quantity_needed_;
-
-		//file >> product_type_;
-		file.getline(psku_, max_sku_length, ',');
+		//the price is extracted as text: extracting a double from a stream allocates a scratch string
+		char price_[32];
+
+		file.getline(psku, max_sku_length, ',');
 		file.getline(product_name_, max_name_length, ',');
-		file.getline(product_unit_descrp_, max_unit_length, ',');
-		file >> taxable_product_;
+		file.getline(product_unit_descrp, max_unit_length, ',');
+		file >> taxable_product;
 		file.ignore(); // get rid of the ','
-		file >> unit_price_before_tax_;
-		file.ignore();
-		file >> quantity_on_hand_;
+		file.getline(price_, sizeof(price_), ',');
+		file >> quantity_on_hand;
 		file.ignore();
-		file >> quantity_needed_;
+		file >> quantity_needed;
 		file.ignore();
 
-		Product temp = Product(psku_, product_name_, product_unit_descrp_, quantity_on_hand_, taxable_product_, unit_price_before_tax_, quantity_needed_);
-		*this = temp; 
+		if (!file.fail()) {
+			char* end;
+			unit_price_before_tax = strtod(price_, &end);
+			if (end == price_)
+				file.setstate(std::ios::failbit);
+		}
+		name(product_name_);
+		ErrState.clear();
 		return file;
 	}
 
@@ -262,8 +365,8 @@ namespace GMS {
 	error object to the error message noted in brackets.
 	If the istream object is not in a failed state and this function encounters an error on the Quantity needed input, it sets 
 	the error object to the error message noted in brackets.
-	If the istream object has accepted all input successfully, this function stores the input values accepted in a temporary 
-	object and copy assigns it to the current object.*/
+	If the istream object has accepted all input successfully, this function stores the input values accepted in the current 
+	object and clears its error state.*/
 	std::istream & Product::read(std::istream & is)
 	{
 		char sku[max_sku_length + 1];
@@ -314,17 +417,14 @@ namespace GMS {
 		}
 
 		if (!is.fail()) {
-			Product temp = Product(product_type);
-			delete[] temp.product_name;
-			temp.product_name = new char[strlen(name) + 1];
-			strcpy(temp.product_name, name);
-			strcpy(temp.psku, sku);
-			strcpy(temp.product_unit_descrp, unit);
-			temp.quantity_on_hand = qtyh;
-			temp.taxable_product = taxable;
-			temp.unit_price_before_tax = price;
-			temp.quantity_needed = qtyn;
-			*this = temp;
+			Product::name(name);
+			strcpy(psku, sku);
+			strcpy(product_unit_descrp, unit);
+			quantity_on_hand = qtyh;
+			taxable_product = taxable;
+			unit_price_before_tax = price;
+			quantity_needed = qtyn;
+			ErrState.clear();
 		}
 		is.ignore(2000, '\n'); //ignores anything left in the input stream
 		return is;
@@ -21,8 +21,29 @@ namespace GMS {
 	const int max_name_length = 75;
 	const double TAX_RATE = 0.13;
 
+	/*Names of up to inline_name_length characters are stored inside the Product object itself; only longer names
+	are allocated in dynamic memory, in a reference-counted block that copies of the product share. The capacity can be changed at build time by defining GMS_INLINE_NAME_LENGTH.*/
+#ifndef GMS_INLINE_NAME_LENGTH
+#define GMS_INLINE_NAME_LENGTH 31
+#endif
+	const int inline_name_length = GMS_INLINE_NAME_LENGTH;
+
+	class InventoryStore;
+	struct ProductRecord;
+	class ReportWriter;
+	class RecordWriter;
+
+	/*The iProduct functions that Perishable does not override are final, so that a call through a Product or Perishable
+	of known static type (as in ProductSet) is bound at compile time and can be inlined.*/
 	class Product : public iProduct {
 
+	//The InventoryStore and the file record parser copy products field by field; the report and record writers
+	//format them field by field.
+		friend class InventoryStore;
+		friend struct ProductRecord;
+		friend class ReportWriter;
+		friend class RecordWriter;
+
 	//A character that indicates the type of the product  for use in the file record
 		char product_type;
 
@@ -34,9 +55,20 @@ namespace GMS {
 	//is defined by the namespace constant.
 		char product_unit_descrp[max_unit_length+1];
 
-	//A pointer that holds the address of a C - style string in dynamic memory containing the name of the product.
+	//A pointer that holds the address of a C - style string containing the name of the product: either inline_name,
+	//for a short name, or a reference-counted block of dynamic memory for a long one. The block is shared by every
+	//copy of the product and is never modified, so copying a product with a long name allocates nothing.
 		char* product_name;
 
+	//A character array that holds a name of at most inline_name_length characters without any dynamic allocation.
+		char inline_name[inline_name_length + 1];
+
+	//This query returns true if product_name points to a shared block of dynamic memory.
+		bool nameAllocated() const;
+
+	//This function drops the reference of the object to its shared name block, if any; the last reference frees it.
+		void releaseName();
+
 	//An integer that holds the quantity of the product currently on hand; that is, the number of units currently on hand.
 		int quantity_on_hand;
 
@@ -55,14 +87,14 @@ namespace GMS {
 	protected:
 
 		/*This function receives the address of a C - style null - terminated string that holds the name of the product.This function
-		stores the name in dynamically allocated memory
+		stores the name inside the object if it fits in inline_name_length characters, and in dynamically allocated memory otherwise
 		replaces any name previously stored
 		If the incoming parameter holds the nullptr address, this function removes the name of the product, if any, from memory.*/
 		void name(const char*);
 
 		/*This query returns the address of the C - style string that holds the name of the product.If the product has no name, this 
 		query returns nullptr.*/
-		const char* name() const;
+		const char* name() const final;
 		
 		/*This query returns the address of the C - style string that holds the sku of the product.*/
 		const char* sku() const;
@@ -115,6 +147,16 @@ namespace GMS {
 		This operator receives an unmodifiable reference to a Product object and replaces the current object with a copy of the object referenced.*/
 		Product& operator=(const Product& product);
 
+		/*Move Constructor
+		This constructor receives a Product object that is about to expire and takes over its name (if the name is held in 
+		dynamic memory) and its error message instead of copying them. The object moved from is left in a safe empty state.*/
+		Product(Product&& product) noexcept;
+
+		/*Move Assignment Operator
+		This operator replaces the current object with the contents of a Product object that is about to expire, taking over
+		its dynamic memory instead of copying it. The object moved from is left in a safe empty state.*/
+		Product& operator=(Product&& product) noexcept;
+
 		/*Destructor
 		This function deallocates any memory that has been dynamically allocated.*/
 		~Product();
@@ -127,8 +169,8 @@ namespace GMS {
 
 		/*This modifier receives a reference to an fstream object and returns a reference to that fstream object.This function
 		extracts the fields for a single record from the fstream object
-		creates a temporary object from the extracted field data
-		copy assigns the temporary object to the current object.*/
+		stores the extracted field data directly in the current object, reusing its storage, and clears its error state.
+		The product type is not changed.*/
 		std::fstream& load(std::fstream& file);
 
 		/*This query receives a reference to an ostream object and a bool and returns a reference to the ostream object.This 
@@ -175,20 +217,20 @@ namespace GMS {
 		sets the error object to the error message noted in brackets.
 		If the istream object is not in a failed state and this function encounters an error on the Quantity needed input, 
 		it sets the error object to the error message noted in brackets.
-		If the istream object has accepted all input successfully, this function stores the input values accepted in a 
-		temporary object and copy assigns it to the current object.*/
+		If the istream object has accepted all input successfully, this function stores the input values accepted in the 
+		current object and clears its error state.*/
 		std::istream& read(std::istream& is);
 
 		/*This query receives the address of an unmodifiable C - style null - terminated string and returns true if 
 		the string is identical to the sku of the current object; false otherwise.*/
-		bool operator==(const char*) const;
+		bool operator==(const char*) const final;
 
 		/*This query that returns the total cost of all items of the product on hand, taxes included.*/
-		double total_cost() const;
+		double total_cost() const final;
 
 		//This modifier that receives an integer holding the number of units of the Product that are on hand.This 
 		//function resets the number of units that are on hand to the number received.
-		void quantity(int);
+		void quantity(int) final;
 
 		/*This query returns true if the object is in a safe empty state; false otherwise.
 		int qtyNeeded() const
@@ -196,10 +238,10 @@ namespace GMS {
 		bool isEmpty() const;
 
 		//This query that returns the number of units of the product that are needed.
-		int qtyNeeded() const;
+		int qtyNeeded() const final;
 
 		//This query returns the number of units of the product that are on hand.
-		int quantity() const;
+		int quantity() const final;
 		
 		/*This query receives the address of a C - style null - terminated string holding a product sku and returns 
 		true if the sku of the current object is greater than the string stored at the received address(according to 
@@ -209,13 +251,13 @@ namespace GMS {
 		/*This query receives an unmodifiable reference to a Product object and returns true if the name of the 
 		current object is greater than the name of the referenced Product object(according to how the string comparison 
 		functions define greater than); false otherwise.*/
-		bool operator>(const iProduct&) const;
+		bool operator>(const iProduct&) const final;
 		
 		/*This modifier receives an integer identifying the number of units to be added to the Product and returns 
 		the updated number of units on hand.If the integer received is positive - valued, this function adds it to 
 		the quantity on hand.If the integer is negative - valued or zero, this function does nothing and returns the 
 		quantity on hand(without modification).*/
-		int operator+=(int);
+		int operator+=(int) final;
 
 	};
 
@@ -0,0 +1,249 @@
+#include <cstring>
+#include <cstdlib>
+#include "ProductRecord.h"
+
+namespace GMS {
+
+	//exact powers of ten representable in a double
+	static const double powers_of_ten[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	//copies the characters in [first, last) into a fixed-width cell, truncating them to the cell capacity
+	template <size_t N>
+	static void copyField(char (&cell)[N], const char* first, const char* last)
+	{
+		size_t length = (size_t)(last - first);
+		if (length > N - 1)
+			length = N - 1;
+		memcpy(cell, first, length);
+		cell[length] = '\0';
+	}
+
+	//parses an optionally signed decimal integer that fills [first, last) exactly
+	bool ProductRecord::parseInt(const char* first, const char* last, int& value)
+	{
+		bool negative = false;
+		if (first != last && (*first == '-' || *first == '+')) {
+			negative = *first == '-';
+			++first;
+		}
+		if (first == last)
+			return false;
+		long long result = 0;
+		for (; first != last; ++first) {
+			if (*first < '0' || *first > '9' || result > 2147483648LL)
+				return false;
+			result = result * 10 + (*first - '0');
+		}
+		result = negative ? -result : result;
+		if (result < -2147483647LL - 1 || result > 2147483647LL)
+			return false;
+		value = (int)result;
+		return true;
+	}
+
+	/*parses a decimal floating point number that fills [first, last) exactly. Numbers with at most 15 significant
+	digits and a small decimal exponent (everything the default stream precision produces) are converted with a
+	single exactly rounded multiplication or division; anything else falls back to strtod.*/
+	static bool parseDouble(const char* first, const char* last, double& value)
+	{
+		const char* p = first;
+		bool negative = false;
+		if (p != last && (*p == '-' || *p == '+')) {
+			negative = *p == '-';
+			++p;
+		}
+		unsigned long long mantissa = 0;
+		int digits = 0;
+		int exponent = 0;
+		bool any = false;
+		for (; p != last && *p >= '0' && *p <= '9'; ++p) {
+			any = true;
+			if (mantissa != 0 || *p != '0') {
+				if (digits < 19)
+					mantissa = mantissa * 10 + (*p - '0');
+				else
+					++exponent;
+				++digits;
+			}
+		}
+		if (p != last && *p == '.') {
+			for (++p; p != last && *p >= '0' && *p <= '9'; ++p) {
+				any = true;
+				if (mantissa != 0 || *p != '0') {
+					if (digits < 19) {
+						mantissa = mantissa * 10 + (*p - '0');
+						--exponent;
+					}
+					++digits;
+				}
+				else {
+					--exponent;
+				}
+			}
+		}
+		if (any && p != last && (*p == 'e' || *p == 'E')) {
+			int e = 0;
+			if (!ProductRecord::parseInt(p + 1, last, e) || e > 400 || e < -400)
+				return false;
+			exponent += e;
+			p = last;
+		}
+		if (!any || p != last)
+			return false;
+
+		if (digits <= 15 && exponent >= -22 && exponent <= 22) {
+			double result = (double)mantissa;
+			result = exponent < 0 ? result / powers_of_ten[-exponent] : result * powers_of_ten[exponent];
+			value = negative ? -result : result;
+			return true;
+		}
+
+		char buffer[64];
+		if ((size_t)(last - first) >= sizeof(buffer))
+			return false;
+		memcpy(buffer, first, (size_t)(last - first));
+		buffer[last - first] = '\0';
+		value = strtod(buffer, nullptr);
+		return true;
+	}
+
+	//returns the end of the field starting at first: the next comma, or the end of the line
+	static const char* fieldEnd(const char* first, const char* last)
+	{
+		const char* comma = static_cast<const char*>(memchr(first, ',', (size_t)(last - first)));
+		return comma != nullptr ? comma : last;
+	}
+
+	//This constructor sets the record to a safe empty state.
+	ProductRecord::ProductRecord()
+	{
+		type = 'N';
+		sku[0] = '\0';
+		name = "";
+		name_length = 0;
+		unit[0] = '\0';
+		taxed = true;
+		price = 0.0;
+		quantity = 0;
+		needed = 0;
+	}
+
+	//This function advances the cursor past any blank lines and returns true if a record line follows.
+	bool ProductRecord::next(const char *& cursor, const char * last)
+	{
+		while (cursor != last && (*cursor == '\n' || *cursor == '\r'))
+			++cursor;
+		return cursor != last;
+	}
+
+	/*This modifier parses the record on the line at the cursor and advances the cursor past that line.*/
+	bool ProductRecord::parse(const char *& cursor, const char * last)
+	{
+		const char* line = cursor;
+		const char* newline = static_cast<const char*>(memchr(line, '\n', (size_t)(last - line)));
+		const char* end = newline != nullptr ? newline : last;
+		cursor = newline != nullptr ? newline + 1 : last;
+		if (end != line && end[-1] == '\r')
+			--end;
+
+		//type
+		const char* p = line;
+		const char* f = fieldEnd(p, end);
+		if (f - p != 1 || f == end)
+			return false;
+		type = *p;
+		expiry = Date();
+
+		//sku, name, unit
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end)
+			return false;
+		copyField(sku, p, f);
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end)
+			return false;
+		name = p;
+		name_length = (size_t)(f - p) > (size_t)max_name_length ? (size_t)max_name_length : (size_t)(f - p);
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end)
+			return false;
+		copyField(unit, p, f);
+
+		//taxable, price, quantity on hand, quantity needed
+		int flag = 0;
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end || !parseInt(p, f, flag))
+			return false;
+		taxed = flag != 0;
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end || !parseDouble(p, f, price))
+			return false;
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (f == end || !parseInt(p, f, quantity))
+			return false;
+		p = f + 1;
+		f = fieldEnd(p, end);
+		if (!parseInt(p, f, needed))
+			return false;
+
+		//expiry date of a perishable product
+		if (type == 'P') {
+			if (f == end)
+				return false;
+			p = f + 1;
+			f = fieldEnd(p, end);
+			//the date must fill the field; out-of-range numbers give an empty date with an error code
+			if (expiry.parse(p, f) != f)
+				return false;
+		}
+		return true;
+	}
+
+	//This query copies the record into the referenced product.
+	void ProductRecord::copy(Product & product) const
+	{
+		char buffer[max_name_length + 1];
+		memcpy(buffer, name, name_length);
+		buffer[name_length] = '\0';
+
+		strcpy(product.psku, sku);
+		product.name(nullptr);
+		product.name(buffer);
+		strcpy(product.product_unit_descrp, unit);
+		product.quantity_on_hand = quantity;
+		product.quantity_needed = needed;
+		product.unit_price_before_tax = price;
+		product.taxable_product = taxed;
+		product.ErrState.message("");
+	}
+
+	void ProductRecord::copy(Perishable & product) const
+	{
+		copy(static_cast<Product&>(product));
+		product.per_prod_exp_date = expiry;
+	}
+
+	//This query allocates a new Product or Perishable holding the record and returns its address.
+	iProduct * ProductRecord::create() const
+	{
+		if (type == 'P') {
+			Perishable* perishable = static_cast<Perishable*>(CreatePerishable());
+			copy(*perishable);
+			return perishable;
+		}
+		else {
+			Product* general = static_cast<Product*>(CreateProduct());
+			copy(*general);
+			return general;
+		}
+	}
+}
@@ -0,0 +1,60 @@
+//The ProductRecord struct holds the fields of a single product file record, as written by Product::store and
+//Perishable::store, parsed straight out of a character buffer.
+
+#ifndef GMS_ProductRecord_H
+#define GMS_ProductRecord_H
+
+#include "Product.h"
+#include "Perishable.h"
+#include "Date.h"
+
+namespace GMS {
+
+	/*A file record looks like
+
+		N,1234,box,kg,1,123.45,1,5
+		P,1234,water,liter,0,1.5,1,5,2018/03/28
+
+	that is: type, sku, name, unit, taxable (1 or 0), price, quantity on hand, quantity needed and, for a perishable
+	product, the expiry date. The record parser works on raw characters and never touches a stream. The name is not
+	copied: it is a view into the parsed buffer, given by its address and length (it is not null-terminated).*/
+	struct ProductRecord {
+
+		char type;
+		char sku[max_sku_length + 1];
+		const char* name;
+		size_t name_length;
+		char unit[max_unit_length + 1];
+		bool taxed;
+		double price;
+		int quantity;
+		int needed;
+		Date expiry;
+
+		//This constructor sets the record to a safe empty state.
+		ProductRecord();
+
+		/*This function advances the cursor past any blank lines and returns true if a record line follows, that is if
+		the cursor has not reached the end of the buffer (last).*/
+		static bool next(const char*& cursor, const char* last);
+
+		/*This function parses an optionally signed decimal integer that fills [first, last) exactly into value and
+		returns true, or returns false (leaving value unchanged) if the characters are not such an integer or it does
+		not fit in an int. The other line formats (StockMove) parse their integer fields with it as well.*/
+		static bool parseInt(const char* first, const char* last, int& value);
+
+		/*This modifier parses the record on the line at the cursor and advances the cursor past that line. It returns
+		true if a valid record has been parsed and false if the line is malformed. Names longer than max_name_length,
+		skus and units are truncated like the fixed-width fields of a Product.*/
+		bool parse(const char*& cursor, const char* last);
+
+		//This query copies the record into the referenced product (the expiry date as well for a Perishable).
+		void copy(Product& product) const;
+		void copy(Perishable& product) const;
+
+		//This query allocates a new Product or Perishable (depending on the record type) holding the record and returns
+		//its address. The caller owns the object.
+		iProduct* create() const;
+	};
+}
+#endif // !GMS_ProductRecord_H
@@ -0,0 +1,131 @@
+#include <utility>
+#include "ProductSet.h"
+
+namespace GMS {
+
+	//This constructor creates an empty set.
+	ProductSet::ProductSet()
+	{
+	}
+
+	size_t ProductSet::size() const
+	{
+		return regular.size() + perishable.size();
+	}
+
+	bool ProductSet::empty() const
+	{
+		return regular.empty() && perishable.empty();
+	}
+
+	void ProductSet::reserve(size_t regularCount, size_t perishableCount)
+	{
+		regular.reserve(regularCount);
+		perishable.reserve(perishableCount);
+	}
+
+	void ProductSet::clear()
+	{
+		regular.clear();
+		perishable.clear();
+	}
+
+	Product & ProductSet::add(const Product & product)
+	{
+		regular.push_back(product);
+		return regular.back();
+	}
+
+	Product & ProductSet::add(Product && product)
+	{
+		regular.push_back(std::move(product));
+		return regular.back();
+	}
+
+	Perishable & ProductSet::add(const Perishable & product)
+	{
+		perishable.push_back(product);
+		return perishable.back();
+	}
+
+	Perishable & ProductSet::add(Perishable && product)
+	{
+		perishable.push_back(std::move(product));
+		return perishable.back();
+	}
+
+	//This modifier appends a copy of the referenced iProduct to the segment of its dynamic type.
+	iProduct * ProductSet::add(const iProduct & product)
+	{
+		const Perishable* dated = dynamic_cast<const Perishable*>(&product);
+		const Product* general = dynamic_cast<const Product*>(&product);
+		if (dated != nullptr)
+			return &add(*dated);
+		if (general != nullptr)
+			return &add(*general);
+		return nullptr;
+	}
+
+	const std::vector<Product>& ProductSet::products() const
+	{
+		return regular;
+	}
+
+	const std::vector<Perishable>& ProductSet::perishables() const
+	{
+		return perishable;
+	}
+
+	//This query returns the address of the product with the given sku, or nullptr if there is none.
+	iProduct * ProductSet::find(const char * sku)
+	{
+		for (Product& product : regular) {
+			if (product == sku)
+				return &product;
+		}
+		for (Perishable& product : perishable) {
+			if (product == sku)
+				return &product;
+		}
+		return nullptr;
+	}
+
+	const iProduct * ProductSet::find(const char * sku) const
+	{
+		return const_cast<ProductSet*>(this)->find(sku);
+	}
+
+	//This query appends the address of every product to the vector.
+	void ProductSet::pointers(std::vector<iProduct*>& products)
+	{
+		products.reserve(products.size() + size());
+		for_each([&products](iProduct& product) { products.push_back(&product); });
+	}
+
+	//This query returns the total cost of all units on hand of all products, taxes included.
+	double ProductSet::total_cost() const
+	{
+		return reduce(0.0, [](double total, const auto& product) { return total + product.total_cost(); });
+	}
+
+	/*This query writes every product, each followed by a newline. The regular products are Products exactly (the
+	segment holds them by value), so their write function is called directly.*/
+	std::ostream & ProductSet::write(std::ostream & os, bool linear) const
+	{
+		for (const Product& product : regular)
+			product.Product::write(os, linear) << '\n';
+		for (const Perishable& product : perishable)
+			product.write(os, linear) << '\n';
+		return os;
+	}
+
+	//This query stores every product as a file record.
+	std::fstream & ProductSet::store(std::fstream & file) const
+	{
+		for (const Product& product : regular)
+			product.Product::store(file);
+		for (const Perishable& product : perishable)
+			product.store(file);
+		return file;
+	}
+}
@@ -0,0 +1,130 @@
+//The ProductSet class keeps Products and Perishables by value, each type in its own contiguous segment.
+
+#ifndef GMS_ProductSet_H
+#define GMS_ProductSet_H
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+
+namespace GMS {
+
+	/*A ProductSet holds the two product types in two segments: a vector of Product and a vector of Perishable. The
+	algorithms (for_each, transform, reduce) are templates that call their function with a Product& for every product
+	of the first segment and a Perishable& for every product of the second, so the function is instantiated once per
+	type and every product function it calls is bound at compile time (see the final functions of Product) instead of
+	going through the iProduct virtual table. The algorithms visit all regular ('N') products first, then all
+	perishable ('P') products, each segment in insertion order.
+
+	The products are still iProducts: legacy callers can take the address of any of them, or collect them all with
+	pointers(). Those addresses are invalidated by any modifier that adds or removes products.*/
+	class ProductSet {
+
+		std::vector<Product> regular;
+		std::vector<Perishable> perishable;
+
+	public:
+
+		//This constructor creates an empty set.
+		ProductSet();
+
+		//This query returns the number of products in the set.
+		size_t size() const;
+
+		//This query returns true if the set holds no products.
+		bool empty() const;
+
+		//This modifier reserves room for the given numbers of regular and perishable products.
+		void reserve(size_t regularCount, size_t perishableCount);
+
+		//This modifier removes every product.
+		void clear();
+
+		//These modifiers append a copy of the product (or move it in) to the segment of its type and return a
+		//reference to the stored product.
+		Product& add(const Product& product);
+		Product& add(Product&& product);
+		Perishable& add(const Perishable& product);
+		Perishable& add(Perishable&& product);
+
+		/*This modifier appends a copy of the referenced iProduct to the segment of its dynamic type and returns the
+		address of the stored product, or nullptr if the iProduct is neither a Product nor a Perishable.*/
+		iProduct* add(const iProduct& product);
+
+		//These queries return the segments.
+		const std::vector<Product>& products() const;
+		const std::vector<Perishable>& perishables() const;
+
+		//This query returns the address of the product with the given sku, or nullptr if there is none.
+		iProduct* find(const char* sku);
+		const iProduct* find(const char* sku) const;
+
+		//This query appends the address of every product, in algorithm order, to the vector.
+		void pointers(std::vector<iProduct*>& products);
+
+		//This function calls f(product) for every product.
+		template <typename Function>
+		void for_each(Function f);
+		template <typename Function>
+		void for_each(Function f) const;
+
+		//This query writes f(product) for every product to the output iterator and returns the iterator past the end.
+		template <typename Output, typename Function>
+		Output transform(Output out, Function f) const;
+
+		//This query returns the result of value = f(value, product) over every product, starting from init.
+		template <typename T, typename Function>
+		T reduce(T init, Function f) const;
+
+		//This query returns the total cost of all units on hand of all products, taxes included.
+		double total_cost() const;
+
+		//This query writes every product (Product::write, Perishable::write), each followed by a newline.
+		std::ostream& write(std::ostream& os, bool linear) const;
+
+		//This query stores every product as a file record (Product::store, Perishable::store).
+		std::fstream& store(std::fstream& file) const;
+	};
+
+	template <typename Function>
+	void ProductSet::for_each(Function f)
+	{
+		for (Product& product : regular)
+			f(product);
+		for (Perishable& product : perishable)
+			f(product);
+	}
+
+	template <typename Function>
+	void ProductSet::for_each(Function f) const
+	{
+		for (const Product& product : regular)
+			f(product);
+		for (const Perishable& product : perishable)
+			f(product);
+	}
+
+	template <typename Output, typename Function>
+	Output ProductSet::transform(Output out, Function f) const
+	{
+		for (const Product& product : regular)
+			*out++ = f(product);
+		for (const Perishable& product : perishable)
+			*out++ = f(product);
+		return out;
+	}
+
+	template <typename T, typename Function>
+	T ProductSet::reduce(T init, Function f) const
+	{
+		for (const Product& product : regular)
+			init = f(init, product);
+		for (const Perishable& product : perishable)
+			init = f(init, product);
+		return init;
+	}
+}
+#endif // !GMS_ProductSet_H
@@ -0,0 +1,300 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include "RecordWriter.h"
+
+namespace GMS {
+
+	//the most characters a double can take in its shortest round-trip form ("-2.2250738585072014e-308")
+	static const size_t max_price_length = 32;
+
+	//the most characters an int can take
+	static const size_t max_int_length = 12;
+
+#ifdef _WIN32
+	static void* const no_file = INVALID_HANDLE_VALUE;
+#else
+	static const int no_file = -1;
+#endif
+
+	//copies a null-terminated string and returns the address past its last character
+	static char* text(char* p, const char* value)
+	{
+		size_t length = strlen(value);
+		memcpy(p, value, length);
+		return p + length;
+	}
+
+	//writes an int as the stream does
+	static char* integer(char* p, int value)
+	{
+		unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+		char reversed[max_int_length];
+		size_t count = 0;
+		do {
+			reversed[count++] = (char)('0' + magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0);
+		if (value < 0)
+			*p++ = '-';
+		while (count > 0)
+			*p++ = reversed[--count];
+		return p;
+	}
+
+	/*writes a double in its shortest form that reads back as the same double. Where the library has no floating point
+	to_chars (the VS2017 toolset), 17 significant digits are written instead: always enough to read back the same
+	double, though not always the shortest.*/
+	static char* price(char* p, double value)
+	{
+#if defined(__cpp_lib_to_chars)
+		std::to_chars_result result = std::to_chars(p, p + max_price_length, value);
+		return result.ec == std::errc() ? result.ptr : p;
+#else
+		int length = snprintf(p, max_price_length, "%.17g", value);
+		return p + (length > 0 ? length : 0);
+#endif
+	}
+
+	//This constructor creates a writer with a buffer of the given size and no open file.
+	RecordWriter::RecordWriter(size_t capacity_) : capacity(capacity_), used(0), total(0), failed(false), file(no_file)
+	{
+		if (capacity < 4096)
+			capacity = 4096;
+		buffer.reset(new char[capacity]);
+	}
+
+	//The destructor closes the file, if any.
+	RecordWriter::~RecordWriter()
+	{
+		close();
+	}
+
+	bool RecordWriter::open(const char * filename)
+	{
+		close();
+		used = 0;
+		total = 0;
+		failed = false;
+#ifdef _WIN32
+		file = CreateFileA(filename, GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+#else
+		file = ::open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+#endif
+		return file != no_file;
+	}
+
+	//writes the buffer to the file and empties it; nothing is written once a write has failed or if no file is open
+	bool RecordWriter::drain()
+	{
+		const char* p = buffer.get();
+		size_t left = used;
+		used = 0;
+		if (file == no_file)
+			failed = true;
+		while (!failed && left != 0) {
+#ifdef _WIN32
+			DWORD count = 0;
+			DWORD chunk = left > 0x40000000 ? 0x40000000 : (DWORD)left;
+			if (!WriteFile(file, p, chunk, &count, nullptr) || count == 0)
+				failed = true;
+#else
+			ssize_t count = ::write(file, p, left);
+			if (count < 0 && errno == EINTR)
+				continue;
+			if (count <= 0)
+				failed = true;
+#endif
+			if (!failed) {
+				p += count;
+				left -= (size_t)count;
+			}
+		}
+		return !failed;
+	}
+
+	//returns the address of room for the given number of characters, writing the buffer to the file if it is full and
+	//growing it if it is too small for them even when empty
+	char * RecordWriter::room(size_t count)
+	{
+		if (used + count > capacity) {
+			drain();
+			if (count > capacity) {
+				buffer.reset(new char[count]);
+				capacity = count;
+			}
+		}
+		return buffer.get() + used;
+	}
+
+	void RecordWriter::record(char type, const char * sku, const char * name, const char * unit, bool taxed,
+		double value, int qtyOnHand, int qtyNeeded, const Date * expiry)
+	{
+		if (name == nullptr)
+			name = "";
+		size_t nameLength = strlen(name);
+		char* first = room(nameLength + max_sku_length + max_unit_length + max_price_length + 2 * max_int_length +
+			max_date_length + 16);
+		char* p = first;
+
+		*p++ = type;
+		*p++ = ',';
+		p = text(p, sku);
+		*p++ = ',';
+		memcpy(p, name, nameLength);
+		p += nameLength;
+		*p++ = ',';
+		p = text(p, unit);
+		*p++ = ',';
+		*p++ = taxed ? '1' : '0';
+		*p++ = ',';
+		p = price(p, value);
+		*p++ = ',';
+		p = integer(p, qtyOnHand);
+		*p++ = ',';
+		p = integer(p, qtyNeeded);
+		if (expiry != nullptr) {
+			*p++ = ',';
+			p += expiry->format(p);
+		}
+		*p++ = '\n';
+
+		used += (size_t)(p - first);
+		total += (unsigned long long)(p - first);
+	}
+
+	void RecordWriter::write(const Product & product)
+	{
+		record(product.product_type, product.psku, product.product_name, product.product_unit_descrp,
+			product.taxable_product, product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed,
+			nullptr);
+	}
+
+	void RecordWriter::write(const Perishable & product)
+	{
+		record(product.product_type, product.psku, product.product_name, product.product_unit_descrp,
+			product.taxable_product, product.unit_price_before_tax, product.quantity_on_hand, product.quantity_needed,
+			&product.per_prod_exp_date);
+	}
+
+	void RecordWriter::write(const InventoryStore & store, size_t row)
+	{
+		record(store.type(row), store.sku(row), store.name(row), store.unit(row), store.taxed(row), store.price(row),
+			store.quantity(row), store.qtyNeeded(row), store.type(row) == 'P' ? &store.expiry(row) : nullptr);
+	}
+
+	//This modifier appends the record of a Product, Perishable or ProductView, and fails the writer for any other
+	//iProduct.
+	void RecordWriter::write(const iProduct & product)
+	{
+		const Perishable* perishable = dynamic_cast<const Perishable*>(&product);
+		const Product* general = dynamic_cast<const Product*>(&product);
+		const ProductView* view = dynamic_cast<const ProductView*>(&product);
+		if (perishable != nullptr)
+			write(*perishable);
+		else if (general != nullptr)
+			write(*general);
+		else if (view != nullptr)
+			write(*view->inventory, view->row);
+		else
+			failed = true;
+	}
+
+	void RecordWriter::write(const InventoryStore & store)
+	{
+		for (size_t row = 0; row < store.size(); ++row)
+			write(store, row);
+	}
+
+	void RecordWriter::write(const ProductSet & products)
+	{
+		products.for_each([this](const auto& product) { write(product); });
+	}
+
+	void RecordWriter::write(const iProduct * const * products, size_t count)
+	{
+		for (size_t i = 0; i < count; ++i)
+			write(*products[i]);
+	}
+
+	//This modifier writes the rest of the buffer, forces the file to disk and closes it.
+	bool RecordWriter::commit()
+	{
+		bool committed = drain();
+		if (committed) {
+#ifdef _WIN32
+			committed = FlushFileBuffers(file) != 0;
+#else
+			while (fsync(file) != 0) {
+				if (errno != EINTR) {
+					committed = false;
+					break;
+				}
+			}
+#endif
+		}
+		if (file != no_file) {
+#ifdef _WIN32
+			committed = CloseHandle(file) != 0 && committed;
+#else
+			committed = ::close(file) == 0 && committed;
+#endif
+			file = no_file;
+		}
+		return committed;
+	}
+
+	//This modifier writes the rest of the buffer and closes the file without forcing it to disk.
+	void RecordWriter::close()
+	{
+		if (file == no_file)
+			return;
+		drain();
+#ifdef _WIN32
+		CloseHandle(file);
+#else
+		::close(file);
+#endif
+		file = no_file;
+	}
+
+	unsigned long long RecordWriter::written() const
+	{
+		return total;
+	}
+
+	bool saveRecords(const char * filename, const InventoryStore & store)
+	{
+		RecordWriter writer;
+		if (!writer.open(filename))
+			return false;
+		writer.write(store);
+		return writer.commit();
+	}
+
+	bool saveRecords(const char * filename, const ProductSet & products)
+	{
+		RecordWriter writer;
+		if (!writer.open(filename))
+			return false;
+		writer.write(products);
+		return writer.commit();
+	}
+
+	bool saveRecords(const char * filename, const iProduct * const * products, size_t count)
+	{
+		RecordWriter writer;
+		if (!writer.open(filename))
+			return false;
+		writer.write(products, count);
+		return writer.commit();
+	}
+}
@@ -0,0 +1,100 @@
+//The RecordWriter class saves products as file records into a large buffer and writes the buffer to the file in big
+//blocks, instead of flushing the file stream after every record.
+
+#ifndef GMS_RecordWriter_H
+#define GMS_RecordWriter_H
+
+#include <memory>
+#include <vector>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+#include "InventoryStore.h"
+#include "ProductSet.h"
+
+namespace GMS {
+
+	/*Every write function appends one file record to the buffer, in the layout of Product::store and
+	Perishable::store, followed by a newline:
+
+		type,sku,name,unit,taxable,price,quantity on hand,quantity needed[,expiry]
+
+	The only difference is the price: it is written with std::to_chars in its shortest form that reads back as exactly
+	the same double (e.g. 12.5, 1234567.89 or 1e+05), where the stream writes 6 significant digits and loses the rest.
+	Both load functions and the file record parser read either form.
+
+	The buffer is written to the file whenever it fills up; commit writes what is left, forces the file to disk
+	(fsync, FlushFileBuffers) and closes it. A file that is closed without being committed (by close or by the
+	destructor) gets everything written so far, but is not forced to disk. Once a write to the file fails, the
+	writer stops writing and commit returns false.*/
+	class RecordWriter {
+
+		std::unique_ptr<char[]> buffer;
+		size_t capacity;
+		size_t used;
+		unsigned long long total;
+		bool failed;
+#ifdef _WIN32
+		void* file;
+#else
+		int file;
+#endif
+
+		//returns the address of room for the given number of characters at the end of the buffer
+		char* room(size_t count);
+		//writes the buffer to the file and empties it; returns false if the file could not be written
+		bool drain();
+		//appends a record from its fields; expiry is nullptr for a regular product
+		void record(char type, const char* sku, const char* name, const char* unit, bool taxed, double price,
+			int qtyOnHand, int qtyNeeded, const Date* expiry);
+
+	public:
+
+		//the size of the buffer used when none is given
+		static const size_t default_capacity = 1 << 20;
+
+		//This constructor creates a writer with a buffer of the given size and no open file.
+		explicit RecordWriter(size_t capacity = default_capacity);
+		RecordWriter(const RecordWriter&) = delete;
+		RecordWriter& operator=(const RecordWriter&) = delete;
+
+		//The destructor closes the file, if any (see close).
+		~RecordWriter();
+
+		//This modifier creates the named file, or truncates it, closing any file previously open, and returns true
+		//on success.
+		bool open(const char* filename);
+
+		//These modifiers append the record of a single product.
+		void write(const Product& product);
+		void write(const Perishable& product);
+		void write(const InventoryStore& store, size_t row);
+
+		/*This modifier appends the record of an iProduct. Products, Perishables and ProductViews are supported; the
+		iProduct interface can only store any other kind into an fstream, so such a product fails the writer.*/
+		void write(const iProduct& product);
+
+		//These modifiers append the records of every product of the store (in row order), of the set (in the order of
+		//its algorithms) or of the array.
+		void write(const InventoryStore& store);
+		void write(const ProductSet& products);
+		void write(const iProduct* const* products, size_t count);
+
+		/*This modifier writes the rest of the buffer to the file, forces the file to disk and closes it. It returns
+		true if every record reached the disk.*/
+		bool commit();
+
+		//This modifier writes the rest of the buffer to the file and closes it without forcing it to disk.
+		void close();
+
+		//This query returns the number of characters appended so far, written or not.
+		unsigned long long written() const;
+	};
+
+	//These functions save every product to the named file with a RecordWriter and return true if every record
+	//reached the disk.
+	bool saveRecords(const char* filename, const InventoryStore& store);
+	bool saveRecords(const char* filename, const ProductSet& products);
+	bool saveRecords(const char* filename, const iProduct* const* products, size_t count);
+}
+#endif // !GMS_RecordWriter_H
@@ -0,0 +1,259 @@
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <charconv>
+#include <sstream>
+#include "ReportWriter.h"
+
+namespace GMS {
+
+	//the field widths of the linear layout of Product::write
+	static const int name_width = 20;
+	static const int cost_width = 7;
+	static const int quantity_width = 4;
+	static const int unit_width = 10;
+
+	//the padding source: at least as many spaces as the widest field
+	static const char spaces[] = "                                ";
+
+	//the most characters a fixed two-decimal double can take (the largest doubles have 309 integer digits)
+	static const size_t max_cost_length = 330;
+
+	//copies text and pads it with spaces on the right to the given width
+	static char* left(char* p, const char* text, size_t length, size_t width)
+	{
+		memcpy(p, text, length);
+		p += length;
+		if (length < width) {
+			memcpy(p, spaces, width - length);
+			p += width - length;
+		}
+		return p;
+	}
+
+	//copies the characters [first, last) and pads them with spaces on the left to the given width
+	static char* right(char* p, const char* first, const char* last, size_t width)
+	{
+		size_t length = (size_t)(last - first);
+		if (length < width) {
+			memcpy(p, spaces, width - length);
+			p += width - length;
+		}
+		memcpy(p, first, length);
+		return p + length;
+	}
+
+	//writes the decimal digits of value at p and returns the address past the last one
+	static char* decimal(char* p, unsigned long long value)
+	{
+		char reversed[20];
+		size_t count = 0;
+		do {
+			reversed[count++] = (char)('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+		while (count > 0)
+			*p++ = reversed[--count];
+		return p;
+	}
+
+	//writes an integer right-aligned in the given width, as std::right << std::setw(width) << value does
+	static char* integer(char* p, int value, size_t width)
+	{
+		char digits[16];
+		char* q = digits;
+		if (value < 0)
+			*q++ = '-';
+		q = decimal(q, value < 0 ? 0ull - (unsigned long long)value : (unsigned long long)value);
+		return right(p, digits, q, width);
+	}
+
+	/*writes a double right-aligned in the given width with two decimals, as std::fixed << std::setprecision(2) <<
+	std::right << std::setw(width) << value does. Both that and std::to_chars with a precision are defined as printf
+	"%.2f"; snprintf stands in where the library has no floating point to_chars.
+
+	Most values take a shortcut: value * 100 is within a quarter of a unit in the last place of the exact product, so
+	when it is not within 2^-10 of a half and is below 2^40, rounding it to the nearest integer gives exactly the
+	cents that printf would print. Ties and everything else go through the general conversion.*/
+	static char* fixed(char* p, double value, size_t width)
+	{
+		char digits[max_cost_length];
+		const char* last;
+		double magnitude = std::signbit(value) ? -value : value;
+		double scaled = magnitude * 100.0;
+		double whole = std::floor(scaled);
+		double fraction = scaled - whole;
+		if (scaled < 1099511627776.0 && std::fabs(fraction - 0.5) > 1.0 / 1024) {
+			unsigned long long cents = (unsigned long long)whole + (fraction > 0.5 ? 1 : 0);
+			char* q = digits;
+			if (std::signbit(value))
+				*q++ = '-';
+			q = decimal(q, cents / 100);
+			*q++ = '.';
+			*q++ = (char)('0' + cents / 10 % 10);
+			*q++ = (char)('0' + cents % 10);
+			last = q;
+		}
+		else {
+#if defined(__cpp_lib_to_chars)
+			std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, 2);
+			last = result.ec == std::errc() ? result.ptr : digits;
+#else
+			int length = snprintf(digits, sizeof(digits), "%.2f", value);
+			last = digits + (length > 0 ? length : 0);
+#endif
+		}
+		return right(p, digits, last, width);
+	}
+
+	//This constructor creates a writer for the referenced stream, with a buffer of the given size.
+	ReportWriter::ReportWriter(std::ostream & os_, size_t capacity_) : os(os_), capacity(capacity_), used(0), total(0)
+	{
+		if (capacity < 4096)
+			capacity = 4096;
+		buffer.reset(new char[capacity]);
+	}
+
+	//The destructor writes what is left in the buffer to the stream.
+	ReportWriter::~ReportWriter()
+	{
+		flush();
+	}
+
+	//returns the address of room for the given number of characters, flushing or growing the buffer as needed
+	char * ReportWriter::room(size_t count)
+	{
+		if (used + count > capacity) {
+			flush();
+			if (count > capacity) {
+				buffer.reset(new char[count]);
+				capacity = count;
+			}
+		}
+		return buffer.get() + used;
+	}
+
+	void ReportWriter::line(const char * sku, const char * name, double cost, int qtyOnHand, const char * unit,
+		int qtyNeeded, const Date * expiry)
+	{
+		if (name == nullptr)
+			name = "";
+		size_t skuLength = strlen(sku);
+		size_t nameLength = strlen(name);
+		size_t unitLength = strlen(unit);
+		char* first = room(skuLength + nameLength + unitLength + max_cost_length + max_date_length + 96);
+		char* p = first;
+
+		p = left(p, sku, skuLength, max_sku_length);
+		*p++ = '|';
+		p = left(p, name, nameLength, name_width);
+		*p++ = '|';
+		p = fixed(p, cost, cost_width);
+		*p++ = '|';
+		p = integer(p, qtyOnHand, quantity_width);
+		*p++ = '|';
+		p = left(p, unit, unitLength, unit_width);
+		*p++ = '|';
+		p = integer(p, qtyNeeded, quantity_width);
+		*p++ = '|';
+		if (expiry != nullptr)
+			p += expiry->format(p);
+		*p++ = '\n';
+
+		used += (size_t)(p - first);
+		total += (unsigned long long)(p - first);
+	}
+
+	void ReportWriter::line(const char * message)
+	{
+		size_t length = strlen(message);
+		char* p = room(length + 1);
+		memcpy(p, message, length);
+		p[length] = '\n';
+		used += length + 1;
+		total += length + 1;
+	}
+
+	void ReportWriter::write(const Product & product)
+	{
+		if (product.ErrState.isClear())
+			line(product.psku, product.product_name, product.cost(), product.quantity_on_hand,
+				product.product_unit_descrp, product.quantity_needed, nullptr);
+		else
+			line(product.ErrState.message());
+	}
+
+	void ReportWriter::write(const Perishable & product)
+	{
+		if (product.ErrState.isClear())
+			line(product.psku, product.product_name, product.cost(), product.quantity_on_hand,
+				product.product_unit_descrp, product.quantity_needed, &product.per_prod_exp_date);
+		else
+			line(product.ErrState.message());
+	}
+
+	void ReportWriter::write(const InventoryStore & store, size_t row)
+	{
+		line(store.sku(row), store.name(row), store.cost(row), store.quantity(row), store.unit(row),
+			store.qtyNeeded(row), store.type(row) == 'P' ? &store.expiry(row) : nullptr);
+	}
+
+	void ReportWriter::write(const StockImage & image, size_t row)
+	{
+		line(image.sku(row), image.name(row), image.cost(row), image.quantity(row), image.unit(row),
+			image.qtyNeeded(row), image.type(row) == 'P' ? &image.expiry(row) : nullptr);
+	}
+
+	//This modifier appends the line of an iProduct of any kind.
+	void ReportWriter::write(const iProduct & product)
+	{
+		const Perishable* perishable = dynamic_cast<const Perishable*>(&product);
+		const Product* general = dynamic_cast<const Product*>(&product);
+		const ProductView* view = dynamic_cast<const ProductView*>(&product);
+		if (perishable != nullptr)
+			write(*perishable);
+		else if (general != nullptr)
+			write(*general);
+		else if (view != nullptr)
+			write(*view->inventory, view->row);
+		else {
+			std::ostringstream text;
+			product.write(text, true);
+			text << '\n';
+			const std::string& rendered = text.str();
+			memcpy(room(rendered.size()), rendered.data(), rendered.size());
+			used += rendered.size();
+			total += rendered.size();
+		}
+	}
+
+	void ReportWriter::write(const InventoryStore & store)
+	{
+		for (size_t row = 0; row < store.size(); ++row)
+			write(store, row);
+	}
+
+	void ReportWriter::write(const StockImage & image)
+	{
+		for (size_t row = 0; row < image.size(); ++row)
+			write(image, row);
+	}
+
+	void ReportWriter::write(const ProductSet & products)
+	{
+		products.for_each([this](const auto& product) { write(product); });
+	}
+
+	//This modifier writes the buffer to the stream and empties it.
+	void ReportWriter::flush()
+	{
+		if (used != 0)
+			os.write(buffer.get(), (std::streamsize)used);
+		used = 0;
+	}
+
+	unsigned long long ReportWriter::written() const
+	{
+		return total;
+	}
+}
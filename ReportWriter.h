@@ -0,0 +1,78 @@
+//The ReportWriter class renders the linear product listing into a large buffer instead of formatting it field by field
+//through a stream.
+
+#ifndef GMS_ReportWriter_H
+#define GMS_ReportWriter_H
+
+#include <iostream>
+#include <memory>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+#include "InventoryStore.h"
+#include "ProductSet.h"
+#include "VersionedStore.h"
+
+namespace GMS {
+
+	/*Every write function appends one line to the report: exactly the characters that write(os, true) of the product
+	inserts into a stream with the default fill character, followed by a newline, i.e.
+
+		sku    |name                |   cost| qty|unit      |need|expiry
+
+	The fields are rendered with std::to_chars and padded from a block of spaces, into a reusable buffer that is
+	written to the stream in a single ostream::write whenever it fills up, and when the writer is flushed or
+	destroyed. Nothing reaches the stream before then. A product without a name is listed with an empty name.*/
+	class ReportWriter {
+
+		std::ostream& os;
+		std::unique_ptr<char[]> buffer;
+		size_t capacity;
+		size_t used;
+		unsigned long long total;
+
+		//returns the address of room for the given number of characters at the end of the buffer
+		char* room(size_t count);
+		//appends a product line from its fields; expiry is nullptr for a regular product
+		void line(const char* sku, const char* name, double cost, int qtyOnHand, const char* unit, int qtyNeeded,
+			const Date* expiry);
+		//appends the error message of a product in an error state as a line
+		void line(const char* message);
+
+	public:
+
+		//the size of the buffer used when none is given
+		static const size_t default_capacity = 1 << 20;
+
+		//This constructor creates a writer for the referenced stream, with a buffer of the given size.
+		explicit ReportWriter(std::ostream& os, size_t capacity = default_capacity);
+		ReportWriter(const ReportWriter&) = delete;
+		ReportWriter& operator=(const ReportWriter&) = delete;
+
+		//The destructor writes what is left in the buffer to the stream.
+		~ReportWriter();
+
+		//These modifiers append the line of a single product.
+		void write(const Product& product);
+		void write(const Perishable& product);
+		void write(const InventoryStore& store, size_t row);
+		void write(const StockImage& image, size_t row);
+
+		/*This modifier appends the line of an iProduct of any kind. Products, Perishables and ProductViews are rendered
+		directly; any other iProduct is rendered through its own write function.*/
+		void write(const iProduct& product);
+
+		//These modifiers append the lines of every product of the store or of the published version (in row order) or
+		//of the set (in the order of its algorithms).
+		void write(const InventoryStore& store);
+		void write(const StockImage& image);
+		void write(const ProductSet& products);
+
+		//This modifier writes the buffer to the stream and empties it.
+		void flush();
+
+		//This query returns the number of characters appended so far, flushed or not.
+		unsigned long long written() const;
+	};
+}
+#endif // !GMS_ReportWriter_H
@@ -0,0 +1,179 @@
+#include <cstring>
+#ifdef _MSC_VER
+#include <xmmintrin.h>
+#define GMS_PREFETCH(address) _mm_prefetch((const char*)(address), _MM_HINT_T0)
+#else
+#define GMS_PREFETCH(address) __builtin_prefetch(address)
+#endif
+#include "SkuIndex.h"
+#include "Product.h"
+
+namespace GMS {
+
+	//how many keys ahead build prefetches
+	static const size_t prefetch_distance = 16;
+
+	//the table is grown once it is more than 7/10 full
+	static const size_t max_load_numerator = 7;
+	static const size_t max_load_denominator = 10;
+	static const size_t min_capacity = 16;
+
+	/*This function packs the first max_sku_length characters of a C-style string into a 64-bit key.*/
+	unsigned long long SkuIndex::pack(const char * sku)
+	{
+		unsigned char bytes[8] = { 0 };
+		if (sku != nullptr) {
+			for (int i = 0; i < max_sku_length && sku[i] != '\0'; ++i) {
+				bytes[i] = static_cast<unsigned char>(sku[i]);
+			}
+		}
+		unsigned long long key = 0;
+		memcpy(&key, bytes, sizeof(key));
+		return key;
+	}
+
+	//returns the first slot of the probe sequence of a key (a 64-bit finalizer mix, masked to the table size)
+	size_t SkuIndex::home(unsigned long long key) const
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return static_cast<size_t>(key) & (slots.size() - 1);
+	}
+
+	//allocates a table of the given capacity (a power of two) and reinserts every key
+	void SkuIndex::rehash(size_t capacity)
+	{
+		std::vector<Slot> old;
+		old.swap(slots);
+		slots.assign(capacity, Slot{ 0, 0 });
+		count = 0;
+		for (size_t i = 0; i < old.size(); ++i) {
+			if (old[i].key != 0)
+				insert(old[i].key, old[i].row);
+		}
+	}
+
+	//This constructor creates an empty index.
+	SkuIndex::SkuIndex() : count(0)
+	{
+	}
+
+	size_t SkuIndex::size() const
+	{
+		return count;
+	}
+
+	void SkuIndex::clear()
+	{
+		slots.clear();
+		count = 0;
+	}
+
+	//This modifier sizes the table so that the given number of skus can be inserted without rehashing.
+	void SkuIndex::reserve(size_t count_)
+	{
+		size_t capacity = min_capacity;
+		while (capacity * max_load_numerator < count_ * max_load_denominator)
+			capacity *= 2;
+		if (capacity > slots.size())
+			rehash(capacity);
+	}
+
+	bool SkuIndex::insert(const char * sku, size_t row)
+	{
+		return insert(pack(sku), row);
+	}
+
+	//This modifier maps the key to the row, replacing the row of a key already in the index.
+	bool SkuIndex::insert(unsigned long long key, size_t row)
+	{
+		if (key == 0)
+			return false;
+		if ((count + 1) * max_load_denominator > slots.size() * max_load_numerator)
+			rehash(slots.empty() ? min_capacity : slots.size() * 2);
+
+		size_t mask = slots.size() - 1;
+		size_t i = home(key);
+		while (slots[i].key != 0 && slots[i].key != key)
+			i = (i + 1) & mask;
+		if (slots[i].key == 0) {
+			slots[i].key = key;
+			++count;
+		}
+		slots[i].row = row;
+		return true;
+	}
+
+	//This modifier replaces the contents of the index with the given keys, mapping keys[i] to row i.
+	void SkuIndex::build(const unsigned long long * keys, size_t count_)
+	{
+		clear();
+		reserve(count_);
+		for (size_t i = 0; i < count_; ++i) {
+			if (i + prefetch_distance < count_)
+				GMS_PREFETCH(&slots[home(keys[i + prefetch_distance])]);
+			insert(keys[i], i);
+		}
+	}
+
+	bool SkuIndex::erase(const char * sku)
+	{
+		return erase(pack(sku));
+	}
+
+	/*This modifier removes the key from the index. The entries that follow the freed slot in its probe cluster are
+	shifted back into it whenever their home slot allows, so that no tombstone is left behind.*/
+	bool SkuIndex::erase(unsigned long long key)
+	{
+		if (key == 0 || slots.empty())
+			return false;
+
+		size_t mask = slots.size() - 1;
+		size_t i = home(key);
+		while (slots[i].key != key) {
+			if (slots[i].key == 0)
+				return false;
+			i = (i + 1) & mask;
+		}
+
+		size_t hole = i;
+		size_t next = (hole + 1) & mask;
+		while (slots[next].key != 0) {
+			size_t ideal = home(slots[next].key);
+			//the entry can move into the hole if its home slot is not in the cyclic range (hole, next]
+			if (((next - ideal) & mask) >= ((next - hole) & mask)) {
+				slots[hole] = slots[next];
+				hole = next;
+			}
+			next = (next + 1) & mask;
+		}
+		slots[hole].key = 0;
+		slots[hole].row = 0;
+		--count;
+		return true;
+	}
+
+	size_t SkuIndex::find(const char * sku) const
+	{
+		return find(pack(sku));
+	}
+
+	//This query returns the row mapped to the key, or npos if the key is not in the index.
+	size_t SkuIndex::find(unsigned long long key) const
+	{
+		if (key == 0 || slots.empty())
+			return npos;
+
+		size_t mask = slots.size() - 1;
+		size_t i = home(key);
+		while (slots[i].key != 0) {
+			if (slots[i].key == key)
+				return slots[i].row;
+			i = (i + 1) & mask;
+		}
+		return npos;
+	}
+}
@@ -0,0 +1,68 @@
+//The SkuIndex class maps product skus to rows of a product collection in constant expected time.
+
+#ifndef GMS_SkuIndex_H
+#define GMS_SkuIndex_H
+
+#include <vector>
+
+namespace GMS {
+
+	/*A sku holds at most max_sku_length (7) characters, so a sku together with its null terminator fits in a single
+	64-bit word. The index packs every sku into such a word and stores it in an open-addressing hash table with linear
+	probing. Erased entries are removed by shifting the following entries of the probe sequence back, so the table never
+	holds tombstones and lookups stay short under heavy insert/erase traffic.*/
+	class SkuIndex {
+
+		struct Slot {
+			unsigned long long key;
+			size_t row;
+		};
+
+		//the table; its size is always zero or a power of two, a key of zero marks an empty slot
+		std::vector<Slot> slots;
+		size_t count;
+
+		size_t home(unsigned long long key) const;
+		void rehash(size_t capacity);
+
+	public:
+
+		//the value returned by find when the sku is not in the index
+		static const size_t npos = static_cast<size_t>(-1);
+
+		/*This function packs the first max_sku_length characters of a C-style string into a 64-bit key. Two skus have
+		the same key if and only if they are identical. The empty sku (and nullptr) pack to zero, which is never indexed.*/
+		static unsigned long long pack(const char* sku);
+
+		//This constructor creates an empty index.
+		SkuIndex();
+
+		//This query returns the number of skus in the index.
+		size_t size() const;
+
+		//This modifier removes every sku from the index.
+		void clear();
+
+		//This modifier sizes the table so that the given number of skus can be inserted without rehashing.
+		void reserve(size_t count);
+
+		/*This modifier maps the sku to the row, replacing the row of a sku already in the index. It returns false
+		if the sku is empty and cannot be indexed.*/
+		bool insert(const char* sku, size_t row);
+		bool insert(unsigned long long key, size_t row);
+
+		/*This modifier replaces the contents of the index with the given keys, mapping keys[i] to row i. The table is
+		sized once and the slot of each key is prefetched a few keys ahead, so building a large index is bound by
+		memory bandwidth rather than by one cache miss per key.*/
+		void build(const unsigned long long* keys, size_t count);
+
+		//This modifier removes the sku from the index and returns true if it was present.
+		bool erase(const char* sku);
+		bool erase(unsigned long long key);
+
+		//This query returns the row mapped to the sku, or npos if the sku is not in the index.
+		size_t find(const char* sku) const;
+		size_t find(unsigned long long key) const;
+	};
+}
+#endif // !GMS_SkuIndex_H
@@ -0,0 +1,189 @@
+#include <fstream>
+#include <cstring>
+#include <memory>
+#include <vector>
+#include "Snapshot.h"
+#include "MappedFile.h"
+#include "Checksum.h"
+#include "ProductRecord.h"
+
+namespace GMS {
+
+	//the header of a snapshot file
+	struct SnapshotHeader {
+		char magic[4];
+		unsigned int version;
+		unsigned int record_size;
+		unsigned int reserved;
+		unsigned long long record_count;
+		unsigned long long names_size;
+		unsigned long long checksum;
+	};
+
+	//a product record of a snapshot file; the fields are ordered so that the struct has no padding
+	struct SnapshotRecord {
+		double price;
+		int quantity;
+		int needed;
+		unsigned int name_offset;
+		unsigned short name_length;
+		char type;
+		unsigned char taxed;
+		char sku[max_sku_length + 1];
+		char unit[max_unit_length + 1];
+		unsigned char month;
+		unsigned short year;
+		unsigned char day;
+		unsigned char reserved;
+	};
+
+	static_assert(sizeof(SnapshotHeader) == 40, "snapshot header must be 40 bytes");
+	static_assert(sizeof(SnapshotRecord) == 48, "snapshot record must be 48 bytes");
+
+	static const char snapshot_magic[4] = { 'G', 'M', 'S', 'S' };
+
+	//records are written in batches of this many
+	static const size_t batch_records = 8192;
+
+	//This function writes the store to the named snapshot file and returns true on success.
+	bool saveSnapshot(const char * filename, const InventoryStore & store)
+	{
+		//the names are checked before the file is created, so that no file is written that restoreSnapshot would reject
+		unsigned long long names_size = 0;
+		for (size_t row = 0; row < store.size(); ++row) {
+			const char* name = store.name(row);
+			size_t length = name != nullptr ? strlen(name) : 0;
+			if (length > snapshot_max_name_length)
+				return false;
+			names_size += length + 1;
+		}
+		if (names_size > 0xFFFFFFFFULL)
+			return false;
+
+		std::fstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		SnapshotHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+		header.version = snapshot_version;
+		header.record_size = sizeof(SnapshotRecord);
+		header.record_count = store.size();
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		Checksum checksum;
+		std::vector<SnapshotRecord> batch;
+		batch.reserve(batch_records);
+		unsigned long long offset = 0;
+		for (size_t row = 0; row < store.size(); ++row) {
+			SnapshotRecord record;
+			memset(&record, 0, sizeof(record));
+			const char* name = store.name(row);
+			size_t length = name != nullptr ? strlen(name) : 0;
+			int year, month, day;
+			store.expiry(row).extract(year, month, day);
+
+			record.price = store.price(row);
+			record.quantity = store.quantity(row);
+			record.needed = store.qtyNeeded(row);
+			record.name_offset = (unsigned int)offset;
+			record.name_length = (unsigned short)length;
+			record.type = store.type(row);
+			record.taxed = store.taxed(row) ? 1 : 0;
+			strncpy(record.sku, store.sku(row), max_sku_length);
+			strncpy(record.unit, store.unit(row), max_unit_length);
+			record.year = (unsigned short)year;
+			record.month = (unsigned char)month;
+			record.day = (unsigned char)day;
+			offset += length + 1;
+
+			batch.push_back(record);
+			if (batch.size() == batch_records || row + 1 == store.size()) {
+				size_t bytes = batch.size() * sizeof(SnapshotRecord);
+				checksum.update(batch.data(), bytes);
+				file.write(reinterpret_cast<const char*>(batch.data()), (std::streamsize)bytes);
+				batch.clear();
+			}
+		}
+
+		//the string section
+		std::string names;
+		for (size_t row = 0; row < store.size(); ++row) {
+			const char* name = store.name(row);
+			if (name != nullptr)
+				names += name;
+			names += '\0';
+			if (names.size() >= batch_records * sizeof(SnapshotRecord) || row + 1 == store.size()) {
+				checksum.update(names.data(), names.size());
+				file.write(names.data(), (std::streamsize)names.size());
+				names.clear();
+			}
+		}
+
+		header.names_size = offset;
+		header.checksum = checksum.value();
+		file.seekp(0);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.flush();
+		return !file.fail();
+	}
+
+	/*This function replaces the contents of the store with the named snapshot file and returns true on success.*/
+	bool restoreSnapshot(const char * filename, InventoryStore & store)
+	{
+		std::unique_ptr<MappedFile> file(new MappedFile());
+		if (!file->open(filename) || file->size() < sizeof(SnapshotHeader))
+			return false;
+
+		SnapshotHeader header;
+		memcpy(&header, file->data(), sizeof(header));
+		if (memcmp(header.magic, snapshot_magic, sizeof(header.magic)) != 0 || header.version != snapshot_version ||
+			header.record_size != sizeof(SnapshotRecord))
+			return false;
+		unsigned long long body = file->size() - sizeof(SnapshotHeader);
+		if (header.record_count > body / sizeof(SnapshotRecord) ||
+			header.record_count * sizeof(SnapshotRecord) + header.names_size != body)
+			return false;
+
+		const char* records = file->data() + sizeof(SnapshotHeader);
+		const char* names = records + header.record_count * sizeof(SnapshotRecord);
+		Checksum checksum;
+		checksum.update(records, (size_t)body);
+		if (checksum.value() != header.checksum)
+			return false;
+
+		//validate every name before touching the store, so that a bad file leaves it unchanged
+		for (unsigned long long i = 0; i < header.record_count; ++i) {
+			SnapshotRecord record;
+			memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(record));
+			if ((unsigned long long)record.name_offset + record.name_length >= header.names_size ||
+				names[record.name_offset + record.name_length] != '\0')
+				return false;
+		}
+
+		store.clear();
+		store.reserve((size_t)header.record_count);
+		ProductRecord product;
+		for (unsigned long long i = 0; i < header.record_count; ++i) {
+			SnapshotRecord record;
+			memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(record));
+			product.type = record.type;
+			memcpy(product.sku, record.sku, sizeof(product.sku));
+			product.sku[max_sku_length] = '\0';
+			product.name = names + record.name_offset;
+			product.name_length = record.name_length;
+			memcpy(product.unit, record.unit, sizeof(product.unit));
+			product.unit[max_unit_length] = '\0';
+			product.taxed = record.taxed != 0;
+			product.price = record.price;
+			product.quantity = record.quantity;
+			product.needed = record.needed;
+			product.expiry = record.year != 0 ? Date(record.year, record.month, record.day) : Date();
+			store.appendBorrowed(product);
+		}
+		store.reindex();
+		store.attach(std::move(file));
+		return true;
+	}
+}
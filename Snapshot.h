@@ -0,0 +1,41 @@
+//Binary snapshots of an InventoryStore, for restarting without re-parsing the text product file.
+
+#ifndef GMS_Snapshot_H
+#define GMS_Snapshot_H
+
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	//the version written by saveSnapshot; restoreSnapshot rejects any other version
+	const unsigned snapshot_version = 1;
+
+	//the longest name a snapshot record can hold
+	const size_t snapshot_max_name_length = 0xFFFF;
+
+	/*A snapshot file holds, in this order:
+
+		a 40-byte header: the magic "GMSS", the format version, the size of a record, the number of records,
+		  the size of the string section and a 64-bit checksum of everything that follows the header
+		the records: one fixed-width 48-byte record per product, in row order, holding the type, the taxable flag,
+		  the sku, the unit, the price (the exact bits of the double), both quantities, the expiry date and the
+		  offset and length of the name in the string section
+		the string section: every name followed by a null byte
+
+	The header and the records are written in the native byte order of the machine (little-endian on every supported
+	target), so a snapshot is only read back on a machine of the same byte order. Because prices are stored bit for bit, a store saved and restored writes
+	exactly the same text records (Product::store/Perishable::store) as it did before it was saved.*/
+
+	/*This function writes the store to the named snapshot file and returns true on success. It returns false without
+	creating the file if a name is longer than snapshot_max_name_length characters or if the names (each with its null
+	byte) take more than 4 GiB, since a record could not locate such a name.*/
+	bool saveSnapshot(const char* filename, const InventoryStore& store);
+
+	/*This function replaces the contents of the store with the named snapshot file and returns true on success. The
+	file is memory-mapped and attached to the store: names are borrowed from its string section, not copied, and the
+	sku index is built in a single pass once every record has been appended. If the
+	file cannot be read, is not a snapshot of a supported version, or fails its checksum, the function returns false
+	and leaves the store unchanged.*/
+	bool restoreSnapshot(const char* filename, InventoryStore& store);
+}
+#endif // !GMS_Snapshot_H
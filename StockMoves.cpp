@@ -0,0 +1,138 @@
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include "StockMoves.h"
+#include "MappedFile.h"
+#include "ProductRecord.h"
+#include "SkuIndex.h"
+
+namespace GMS {
+
+	//This constructor sets the movement to a receipt of no units for no sku.
+	StockMove::StockMove() : kind(receipt), units(0)
+	{
+		sku[0] = '\0';
+	}
+
+	StockMove::StockMove(char kind_, const char * sku_, int units_) : kind(kind_), units(units_)
+	{
+		strncpy(sku, sku_ != nullptr ? sku_ : "", max_sku_length);
+		sku[max_sku_length] = '\0';
+	}
+
+	/*This modifier parses the movement on the line at the cursor and advances the cursor past that line.*/
+	bool StockMove::parse(const char *& cursor, const char * last)
+	{
+		const char* line = cursor;
+		const char* newline = static_cast<const char*>(memchr(line, '\n', (size_t)(last - line)));
+		const char* end = newline != nullptr ? newline : last;
+		cursor = newline != nullptr ? newline + 1 : last;
+		if (end != line && end[-1] == '\r')
+			--end;
+
+		//kind
+		if (end - line < 2 || (line[0] != receipt && line[0] != count) || line[1] != ',')
+			return false;
+		kind = line[0];
+
+		//sku
+		const char* p = line + 2;
+		const char* f = static_cast<const char*>(memchr(p, ',', (size_t)(end - p)));
+		if (f == nullptr)
+			return false;
+		size_t length = (size_t)(f - p) < (size_t)max_sku_length ? (size_t)(f - p) : (size_t)max_sku_length;
+		memcpy(sku, p, length);
+		sku[length] = '\0';
+
+		//units, an optionally signed integer that fills the rest of the line
+		return ProductRecord::parseInt(f + 1, end, units);
+	}
+
+	//a run of movements of one product: its row and the range of the sorted movements that belong to it
+	struct MoveRun {
+		size_t row;
+		size_t first;
+		size_t last;
+	};
+
+	/*This function applies the movements grouped by sku. The (packed sku, index) pairs sort the movements by sku and,
+	within a sku, in their original order; each sku is looked up once, and the runs of the skus in the store are
+	then visited in row order, so that the columns of the store are read and written front to back. Each run is
+	folded into a quantity on hand starting from the quantity in the store, recording the quantity after every
+	movement.*/
+	size_t applyMoves(InventoryStore & store, const StockMove * moves, size_t count, MoveResult * results)
+	{
+		std::vector<std::pair<unsigned long long, size_t>> order(count);
+		for (size_t i = 0; i < count; ++i)
+			order[i] = std::make_pair(SkuIndex::pack(moves[i].sku), i);
+		std::sort(order.begin(), order.end());
+
+		std::vector<MoveRun> runs;
+		size_t applied = 0;
+		for (size_t first = 0, last; first < count; first = last) {
+			for (last = first + 1; last < count && order[last].first == order[first].first; ++last)
+				;
+			size_t row = store.find(moves[order[first].second].sku);
+			if (row != InventoryStore::npos) {
+				runs.push_back(MoveRun{ row, first, last });
+				applied += last - first;
+			}
+			else {
+				for (size_t i = first; i < last; ++i)
+					results[order[i].second] = MoveResult{ row, 0 };
+			}
+		}
+		std::sort(runs.begin(), runs.end(), [](const MoveRun& a, const MoveRun& b) { return a.row < b.row; });
+
+		for (const MoveRun& run : runs) {
+			int start = store.quantity(run.row);
+			int quantity = start;
+			for (size_t i = run.first; i < run.last; ++i) {
+				const StockMove& move = moves[order[i].second];
+				if (move.kind == StockMove::count)
+					quantity = move.units;
+				else if (move.units > 0)
+					quantity += move.units;
+				results[order[i].second] = MoveResult{ run.row, quantity };
+			}
+			if (quantity != start)
+				store.quantity(run.row, quantity);
+		}
+		return applied;
+	}
+
+	size_t applyMoves(InventoryStore & store, const std::vector<StockMove>& moves, std::vector<MoveResult>& results)
+	{
+		results.resize(moves.size());
+		return applyMoves(store, moves.data(), moves.size(), results.data());
+	}
+
+	/*This function maps the named movement file, parses every movement and applies them as one batch.*/
+	bool applyMoveFile(const char * filename, InventoryStore & store, std::vector<MoveResult>& results, LoadStats * stats)
+	{
+		MappedFile file;
+		if (!file.open(filename))
+			return false;
+
+		LoadStats counts = { 0, 0 };
+		std::vector<StockMove> moves;
+		const char* cursor = file.data();
+		const char* last = cursor + file.size();
+		StockMove move;
+		while (ProductRecord::next(cursor, last)) {
+			if (move.parse(cursor, last)) {
+				moves.push_back(move);
+				++counts.records;
+			}
+			else {
+				++counts.rejected;
+			}
+		}
+		file.close();
+		applyMoves(store, moves, results);
+
+		if (stats != nullptr)
+			*stats = counts;
+		return true;
+	}
+}
@@ -0,0 +1,64 @@
+//Batches of stock movements (units received and stock counts) applied to an InventoryStore grouped by product, and
+//read from a movement file.
+
+#ifndef GMS_StockMoves_H
+#define GMS_StockMoves_H
+
+#include <vector>
+#include "InventoryStore.h"
+#include "MappedLoader.h"
+
+namespace GMS {
+
+	/*A stock movement applies one of the two quantity changes of a product: a receipt adds a number of units to the
+	quantity on hand like Product::operator+= (a non-positive number changes nothing), a count sets the quantity on
+	hand like Product::quantity(int). In a movement file each movement is a line
+
+		R,1234,12
+		C,1234,40
+
+	that is: the kind (R or C), the sku and the number of units.*/
+	struct StockMove {
+
+		static const char receipt = 'R';
+		static const char count = 'C';
+
+		char kind;
+		char sku[max_sku_length + 1];
+		int units;
+
+		//This constructor sets the movement to a receipt of no units for no sku.
+		StockMove();
+
+		//This constructor sets the movement to the given fields; the sku is truncated like the sku of a Product.
+		StockMove(char kind, const char* sku, int units);
+
+		/*This modifier parses the movement on the line at the cursor and advances the cursor past that line (see
+		ProductRecord::next for skipping blank lines). It returns true if a valid movement has been parsed and false
+		if the line is malformed.*/
+		bool parse(const char*& cursor, const char* last);
+	};
+
+	//The outcome of a movement: the row of its product (InventoryStore::npos if no product has the sku, in which case
+	//nothing changes), and the quantity on hand of the product right after the movement.
+	struct MoveResult {
+		size_t row;
+		int quantity;
+	};
+
+	/*This function applies the movements to the store and writes the outcome of moves[i] to results[i]. The outcomes
+	are those of applying the movements one by one in order, but the movements are grouped by sku first (a sort on
+	the packed skus, stable within a sku): every sku is looked up once, its movements are folded into a single new
+	quantity on hand, and the store is updated once per product, in row order, keeping its indexes and totals in
+	sync. It returns the number of movements whose sku is in the store.*/
+	size_t applyMoves(InventoryStore& store, const StockMove* moves, size_t count, MoveResult* results);
+	size_t applyMoves(InventoryStore& store, const std::vector<StockMove>& moves, std::vector<MoveResult>& results);
+
+	/*This function maps the named movement file, parses its movements and applies them to the store as a single batch
+	like applyMoves, replacing the contents of results with their outcomes in file order; malformed lines are skipped
+	and counted as rejected. It returns false if the file cannot be opened; stats, if not nullptr, receives the
+	movement counts.*/
+	bool applyMoveFile(const char* filename, InventoryStore& store, std::vector<MoveResult>& results,
+		LoadStats* stats = nullptr);
+}
+#endif // !GMS_StockMoves_H
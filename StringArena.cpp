@@ -0,0 +1,112 @@
+#include <cstring>
+#include "StringArena.h"
+
+namespace GMS {
+
+	//strings are appended to blocks of this size; longer strings get a block of their own
+	static const size_t block_size = 64 * 1024;
+	static const size_t min_table = 64;
+
+	//FNV-1a over the characters of the string
+	size_t StringArena::hashOf(const char * text, size_t length)
+	{
+		unsigned long long hash = 0xcbf29ce484222325ULL;
+		for (size_t i = 0; i < length; ++i) {
+			hash ^= (unsigned char)text[i];
+			hash *= 0x100000001b3ULL;
+		}
+		return (size_t)(hash ^ (hash >> 32));
+	}
+
+	//returns room for the given number of bytes, starting a new block when the current one is full
+	char * StringArena::allocate(size_t bytes_)
+	{
+		if (bytes_ > remaining) {
+			size_t size_ = bytes_ > block_size ? bytes_ : block_size;
+			blocks.push_back(std::unique_ptr<char[]>(new char[size_]));
+			cursor = blocks.back().get();
+			remaining = size_;
+		}
+		char* address = cursor;
+		cursor += bytes_;
+		remaining -= bytes_;
+		used += bytes_;
+		return address;
+	}
+
+	//allocates a table of the given capacity (a power of two) and reinserts every entry
+	void StringArena::rehash(size_t capacity)
+	{
+		std::vector<Entry> old;
+		old.swap(table);
+		Entry empty = { nullptr, 0, 0 };
+		table.assign(capacity, empty);
+		size_t mask = capacity - 1;
+		for (size_t i = 0; i < old.size(); ++i) {
+			if (old[i].text != nullptr) {
+				size_t slot = old[i].hash & mask;
+				while (table[slot].text != nullptr)
+					slot = (slot + 1) & mask;
+				table[slot] = old[i];
+			}
+		}
+	}
+
+	//This constructor creates an empty arena.
+	StringArena::StringArena() : cursor(nullptr), remaining(0), used(0), count(0)
+	{
+	}
+
+	/*This modifier returns the address of the interned copy of the first length characters of text.*/
+	const char * StringArena::intern(const char * text, size_t length)
+	{
+		if ((count + 1) * 10 > table.size() * 7)
+			rehash(table.empty() ? min_table : table.size() * 2);
+
+		size_t hash = hashOf(text, length);
+		size_t mask = table.size() - 1;
+		size_t slot = hash & mask;
+		while (table[slot].text != nullptr) {
+			const Entry& entry = table[slot];
+			if (entry.hash == hash && entry.length == length && memcmp(entry.text, text, length) == 0)
+				return entry.text;
+			slot = (slot + 1) & mask;
+		}
+
+		char* copy = allocate(length + 1);
+		memcpy(copy, text, length);
+		copy[length] = '\0';
+		table[slot].text = copy;
+		table[slot].length = length;
+		table[slot].hash = hash;
+		++count;
+		return copy;
+	}
+
+	//This modifier interns a C-style null-terminated string; nullptr is interned as the empty string.
+	const char * StringArena::intern(const char * text)
+	{
+		return text != nullptr ? intern(text, strlen(text)) : intern("", 0);
+	}
+
+	size_t StringArena::size() const
+	{
+		return count;
+	}
+
+	size_t StringArena::bytes() const
+	{
+		return used;
+	}
+
+	//This modifier releases every string.
+	void StringArena::clear()
+	{
+		blocks.clear();
+		table.clear();
+		cursor = nullptr;
+		remaining = 0;
+		used = 0;
+		count = 0;
+	}
+}
@@ -0,0 +1,60 @@
+//The StringArena class stores interned, null-terminated strings in large append-only blocks.
+
+#ifndef GMS_StringArena_H
+#define GMS_StringArena_H
+
+#include <vector>
+#include <memory>
+
+namespace GMS {
+
+	/*Interning a string returns the address of the single copy of that string held by the arena: the first time a
+	string is interned it is appended to the current block, and every later request for an identical string returns
+	the same address. The addresses stay valid until the arena is cleared or destroyed, so they can be stored and
+	copied freely as handles. Strings are never freed individually.*/
+	class StringArena {
+
+		struct Entry {
+			const char* text;
+			size_t length;
+			size_t hash;
+		};
+
+		std::vector<std::unique_ptr<char[]>> blocks;
+		char* cursor;
+		size_t remaining;
+		size_t used;
+
+		//the intern table: open addressing with linear probing, a null text marks an empty slot
+		std::vector<Entry> table;
+		size_t count;
+
+		static size_t hashOf(const char* text, size_t length);
+		char* allocate(size_t bytes);
+		void rehash(size_t capacity);
+
+	public:
+
+		//This constructor creates an empty arena.
+		StringArena();
+		StringArena(const StringArena&) = delete;
+		StringArena& operator=(const StringArena&) = delete;
+
+		/*This modifier returns the address of the interned copy of the first length characters of text, copying them
+		into the arena (followed by a null byte) if no identical string has been interned yet.*/
+		const char* intern(const char* text, size_t length);
+
+		//This modifier interns a C-style null-terminated string; nullptr is interned as the empty string.
+		const char* intern(const char* text);
+
+		//This query returns the number of distinct strings in the arena.
+		size_t size() const;
+
+		//This query returns the number of bytes taken by the strings, null bytes included.
+		size_t bytes() const;
+
+		//This modifier releases every string; all addresses returned so far become invalid.
+		void clear();
+	};
+}
+#endif // !GMS_StringArena_H
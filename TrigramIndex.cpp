@@ -0,0 +1,265 @@
+#include <cstring>
+#include <algorithm>
+#include <iterator>
+#include "TrigramIndex.h"
+
+namespace GMS {
+
+	//the table is grown once it is more than 7/10 full
+	static const size_t max_load_numerator = 7;
+	static const size_t max_load_denominator = 10;
+	static const size_t min_capacity = 1024;
+
+	//the recent rows of a list are merged into its deltas once there are this many, and at least an eighth of the list
+	static const size_t min_recent = 16;
+
+	/*This function appends the distinct trigrams of a C-style string, in ascending order.*/
+	size_t TrigramIndex::grams(const char * text, std::vector<unsigned>& grams)
+	{
+		size_t first = grams.size();
+		if (text != nullptr && text[0] != '\0' && text[1] != '\0') {
+			for (const unsigned char* p = reinterpret_cast<const unsigned char*>(text); p[2] != '\0'; ++p) {
+				grams.push_back((unsigned)p[0] << 16 | (unsigned)p[1] << 8 | p[2]);
+			}
+		}
+		std::sort(grams.begin() + first, grams.end());
+		grams.erase(std::unique(grams.begin() + first, grams.end()), grams.end());
+		return grams.size() - first;
+	}
+
+	//This constructor creates an empty, inactive index.
+	TrigramIndex::TrigramIndex() : live(0), stale(0), active(false)
+	{
+	}
+
+	bool TrigramIndex::built() const
+	{
+		return active;
+	}
+
+	void TrigramIndex::clear()
+	{
+		slots.clear();
+		lists.clear();
+		live = 0;
+		stale = 0;
+	}
+
+	//returns the first slot of the probe sequence of a trigram (a multiplicative hash, masked to the table size)
+	size_t TrigramIndex::home(unsigned gram) const
+	{
+		return (size_t)(((unsigned long long)gram * 0x9e3779b97f4a7c15ULL) >> 32) & (slots.size() - 1);
+	}
+
+	//allocates a table of the given capacity (a power of two) and reinserts every trigram
+	void TrigramIndex::rehash(size_t capacity)
+	{
+		std::vector<Slot> old;
+		old.swap(slots);
+		slots.assign(capacity, Slot{ 0, 0 });
+		for (const Slot& slot : old) {
+			if (slot.gram != 0) {
+				size_t i = home(slot.gram);
+				while (slots[i].gram != 0)
+					i = (i + 1) & (slots.size() - 1);
+				slots[i] = slot;
+			}
+		}
+	}
+
+	const TrigramIndex::Postings * TrigramIndex::find(unsigned gram) const
+	{
+		if (slots.empty())
+			return nullptr;
+		for (size_t i = home(gram); slots[i].gram != 0; i = (i + 1) & (slots.size() - 1)) {
+			if (slots[i].gram == gram)
+				return &lists[slots[i].list];
+		}
+		return nullptr;
+	}
+
+	//returns the list of the trigram, creating an empty one if there is none
+	TrigramIndex::Postings & TrigramIndex::insert(unsigned gram)
+	{
+		if ((lists.size() + 1) * max_load_denominator > slots.size() * max_load_numerator)
+			rehash(slots.empty() ? min_capacity : slots.size() * 2);
+		size_t i = home(gram);
+		for (; slots[i].gram != 0; i = (i + 1) & (slots.size() - 1)) {
+			if (slots[i].gram == gram)
+				return lists[slots[i].list];
+		}
+		slots[i].gram = gram;
+		slots[i].list = (unsigned)lists.size();
+		lists.push_back(Postings{ std::vector<unsigned char>(), 0, 0, std::vector<size_t>() });
+		return lists.back();
+	}
+
+	//appends the difference to the deltas, seven bits per byte, lowest first; the top bit marks a byte that is followed
+	//by another of the same delta
+	static void put(std::vector<unsigned char>& deltas, size_t delta)
+	{
+		while (delta >= 0x80) {
+			deltas.push_back((unsigned char)(delta | 0x80));
+			delta >>= 7;
+		}
+		deltas.push_back((unsigned char)delta);
+	}
+
+	//adds the row: in place after the last encoded row, otherwise to the recent rows
+	void TrigramIndex::add(Postings & postings, size_t row)
+	{
+		if (postings.count == 0 || row > postings.last) {
+			put(postings.deltas, postings.count == 0 ? row : row - postings.last);
+			postings.last = row;
+			++postings.count;
+		}
+		else if (row != postings.last) {
+			postings.recent.push_back(row);
+			if (postings.recent.size() >= min_recent && postings.recent.size() * 8 >= postings.count)
+				fold(postings);
+		}
+	}
+
+	//replaces the deltas of the list with those of the rows, which are in ascending order without duplicates
+	void TrigramIndex::encode(Postings & postings, const std::vector<size_t>& rows)
+	{
+		postings.deltas.clear();
+		size_t previous = 0;
+		for (size_t row : rows) {
+			put(postings.deltas, row - previous);
+			previous = row;
+		}
+		postings.count = rows.size();
+		postings.last = previous;
+	}
+
+	void TrigramIndex::decode(const Postings & postings, std::vector<size_t>& rows)
+	{
+		size_t first = rows.size();
+		rows.reserve(first + postings.count + postings.recent.size());
+		const unsigned char* p = postings.deltas.data();
+		const unsigned char* end = p + postings.deltas.size();
+		size_t row = 0;
+		while (p != end) {
+			size_t delta = 0;
+			int shift = 0;
+			while (*p & 0x80) {
+				delta |= (size_t)(*p++ & 0x7f) << shift;
+				shift += 7;
+			}
+			delta |= (size_t)*p++ << shift;
+			row += delta;
+			rows.push_back(row);
+		}
+		if (!postings.recent.empty()) {
+			size_t middle = rows.size();
+			rows.insert(rows.end(), postings.recent.begin(), postings.recent.end());
+			std::sort(rows.begin() + middle, rows.end());
+			std::inplace_merge(rows.begin() + first, rows.begin() + middle, rows.end());
+			rows.erase(std::unique(rows.begin() + first, rows.end()), rows.end());
+		}
+	}
+
+	void TrigramIndex::fold(Postings & postings)
+	{
+		std::vector<size_t> rows;
+		decode(postings, rows);
+		postings.recent.clear();
+		encode(postings, rows);
+	}
+
+	//This modifier replaces the contents of the index with the rows [0, count), each appended in order.
+	void TrigramIndex::build(const char * const * names, size_t count)
+	{
+		clear();
+		active = true;
+		for (size_t row = 0; row < count; ++row)
+			add(row, names[row]);
+	}
+
+	void TrigramIndex::add(size_t row, const char * name)
+	{
+		if (!active)
+			return;
+		scratch.clear();
+		live += grams(name, scratch);
+		for (unsigned gram : scratch)
+			add(insert(gram), row);
+	}
+
+	void TrigramIndex::drop(const char * name)
+	{
+		if (!active)
+			return;
+		scratch.clear();
+		size_t count = grams(name, scratch);
+		live -= count;
+		stale += count;
+	}
+
+	bool TrigramIndex::wasteful() const
+	{
+		return active && stale >= min_stale && stale > live;
+	}
+
+	size_t TrigramIndex::bytes() const
+	{
+		size_t total = 0;
+		for (const Postings& postings : lists)
+			total += postings.deltas.size() + postings.recent.size() * sizeof(size_t);
+		return total;
+	}
+
+	/*This query intersects the posting lists of the trigrams of the fragments, shortest first, and checks the rows
+	left against their names.*/
+	void TrigramIndex::search(const char * const * terms, size_t termCount, const char * const * names, size_t count,
+		std::vector<size_t>& rows) const
+	{
+		//an inactive index has no lists: every row is checked
+		std::vector<unsigned> wanted;
+		for (size_t t = 0; active && t < termCount; ++t)
+			grams(terms[t], wanted);
+		std::sort(wanted.begin(), wanted.end());
+		wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+		std::vector<const Postings*> needed;
+		for (unsigned gram : wanted) {
+			const Postings* postings = find(gram);
+			if (postings == nullptr)
+				return;
+			needed.push_back(postings);
+		}
+		std::sort(needed.begin(), needed.end(), [](const Postings* a, const Postings* b) {
+			return a->count + a->recent.size() < b->count + b->recent.size();
+		});
+
+		std::vector<size_t> candidates, next, matched;
+		if (needed.empty()) {
+			candidates.resize(count);
+			for (size_t row = 0; row < count; ++row)
+				candidates[row] = row;
+		}
+		else {
+			decode(*needed[0], candidates);
+		}
+		for (size_t i = 1; i < needed.size() && !candidates.empty(); ++i) {
+			next.clear();
+			decode(*needed[i], next);
+			matched.clear();
+			std::set_intersection(candidates.begin(), candidates.end(), next.begin(), next.end(),
+				std::back_inserter(matched));
+			candidates.swap(matched);
+		}
+
+		for (size_t row : candidates) {
+			if (row >= count)
+				break;
+			const char* name = names[row] != nullptr ? names[row] : "";
+			size_t t = 0;
+			while (t < termCount && (terms[t] == nullptr || strstr(name, terms[t]) != nullptr))
+				++t;
+			if (t == termCount)
+				rows.push_back(row);
+		}
+	}
+}
@@ -0,0 +1,105 @@
+//The TrigramIndex class finds the rows of a product collection whose names contain given fragments, without
+//searching every name.
+
+#ifndef GMS_TrigramIndex_H
+#define GMS_TrigramIndex_H
+
+#include <vector>
+
+namespace GMS {
+
+	/*The index maps every trigram (three consecutive characters) of every name to the list of the rows whose names
+	contain it, its posting list. A row can only contain a fragment of three or more characters if its name contains
+	every trigram of the fragment, so a search intersects the posting lists of those trigrams, starting with the
+	shortest, and then checks the few rows left against their current names with strstr. Fragments shorter than a
+	trigram have no trigrams to narrow the search with: if every fragment is that short, every row is checked.
+
+	A posting list holds its rows in ascending order as variable-length deltas, seven bits per byte, so that the
+	lists of a catalog whose rows are numbered densely take one or two bytes per row. Rows appended in order (as a
+	store appends them) are encoded in place; a row added out of order (a product moved by an erase) waits in a short
+	unsorted list until there are enough of them to be merged into the encoded deltas at once.
+
+	A row whose name changes is added to the lists of the trigrams of its new name, but is not removed from the lists
+	of its old name: searches discard such stale rows when they check the names, and the caller rebuilds the index
+	once the stale postings outnumber the live ones (see wasteful). The trigram table itself is an open-addressing
+	hash table with linear probing, like the SkuIndex.*/
+	class TrigramIndex {
+
+		struct Postings {
+			//the deltas of the rows in ascending order, and the number and the last of those rows
+			std::vector<unsigned char> deltas;
+			size_t count;
+			size_t last;
+			//the rows added out of order since the deltas were last rewritten
+			std::vector<size_t> recent;
+		};
+
+		struct Slot {
+			//the trigram (its three characters, first character highest; zero marks an empty slot), and its list
+			unsigned gram;
+			unsigned list;
+		};
+
+		std::vector<Slot> slots;
+		std::vector<Postings> lists;
+		//the postings of the current names, and those left behind by names that have changed
+		size_t live;
+		size_t stale;
+		bool active;
+		//the trigrams of the name being added
+		std::vector<unsigned> scratch;
+
+		size_t home(unsigned gram) const;
+		void rehash(size_t capacity);
+		//the list of the trigram, nullptr if no row contains it
+		const Postings* find(unsigned gram) const;
+		Postings& insert(unsigned gram);
+		static void add(Postings& postings, size_t row);
+		static void encode(Postings& postings, const std::vector<size_t>& rows);
+		//appends the rows of the list in ascending order, without duplicates
+		static void decode(const Postings& postings, std::vector<size_t>& rows);
+		//rewrites the deltas of the list with its recent rows merged in
+		static void fold(Postings& postings);
+
+	public:
+
+		//the least number of stale postings that makes the index wasteful
+		static const size_t min_stale = 1 << 16;
+
+		/*This function appends the distinct trigrams of a C-style string, in ascending order, and returns their number.
+		A string shorter than three characters has none.*/
+		static size_t grams(const char* text, std::vector<unsigned>& grams);
+
+		//This constructor creates an empty, inactive index.
+		TrigramIndex();
+
+		//This query returns true once the index has been built; an inactive index ignores add and drop.
+		bool built() const;
+
+		//This modifier removes every row from the index, which stays active if it was.
+		void clear();
+
+		//This modifier replaces the contents of the index with the rows [0, count), row i named names[i], and
+		//activates the index.
+		void build(const char* const* names, size_t count);
+
+		//This modifier adds the row to the lists of the trigrams of its name (nullptr is the empty name).
+		void add(size_t row, const char* name);
+
+		//This modifier records that a row no longer has the given name: the postings of its trigrams are now stale.
+		void drop(const char* name);
+
+		//This query returns true if the index holds more stale postings than live ones (and at least min_stale).
+		bool wasteful() const;
+
+		//This query returns the number of bytes taken by the encoded posting lists.
+		size_t bytes() const;
+
+		/*This query appends to rows, in ascending order, the rows among [0, count) whose names (names[row]) contain every
+		one of the given fragments. An empty (or null) fragment is contained in every name. An inactive index checks
+		every row.*/
+		void search(const char* const* terms, size_t termCount, const char* const* names, size_t count,
+			std::vector<size_t>& rows) const;
+	};
+}
+#endif // !GMS_TrigramIndex_H
@@ -0,0 +1,141 @@
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GMS_SSE2
+#endif
+#include "Valuation.h"
+#include "VersionedStore.h"
+
+namespace GMS {
+
+	//the four sums kept by the kernel; every product adds to exactly one of them
+	enum { taxed_regular, untaxed_regular, taxed_perishable, untaxed_perishable, categories };
+
+	//the number of rows a subset valuation gathers before running the kernel
+	static const size_t gather_rows = 256;
+
+	/*Adds the value of count products, given as parallel arrays of their columns, to the four sums. The unit cost is
+	price * TAX_RATE + price for a taxable product and price otherwise, as in Product::cost.*/
+	static void accumulate(const char* type, const unsigned char* taxed, const double* price, const int* qty,
+		size_t count, double sums[categories])
+	{
+		size_t i = 0;
+#ifdef GMS_SSE2
+		//four products per iteration; the byte columns are widened into 64-bit lane masks
+		const __m128d rate = _mm_set1_pd(TAX_RATE);
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i perishable = _mm_set1_epi8('P');
+		__m128d tn = _mm_setzero_pd(), un = _mm_setzero_pd(), tp = _mm_setzero_pd(), up = _mm_setzero_pd();
+		for (; i + 4 <= count; i += 4) {
+			int taxed4, type4;
+			memcpy(&taxed4, taxed + i, 4);
+			memcpy(&type4, type + i, 4);
+			__m128i untaxed_mask = _mm_cmpeq_epi8(_mm_cvtsi32_si128(taxed4), zero);
+			__m128i perishable_mask = _mm_cmpeq_epi8(_mm_cvtsi32_si128(type4), perishable);
+			untaxed_mask = _mm_unpacklo_epi16(_mm_unpacklo_epi8(untaxed_mask, untaxed_mask),
+				_mm_unpacklo_epi8(untaxed_mask, untaxed_mask));
+			perishable_mask = _mm_unpacklo_epi16(_mm_unpacklo_epi8(perishable_mask, perishable_mask),
+				_mm_unpacklo_epi8(perishable_mask, perishable_mask));
+
+			__m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(qty + i));
+			__m128d q01 = _mm_cvtepi32_pd(q);
+			__m128d q23 = _mm_cvtepi32_pd(_mm_shuffle_epi32(q, _MM_SHUFFLE(3, 2, 3, 2)));
+			__m128d p01 = _mm_loadu_pd(price + i);
+			__m128d p23 = _mm_loadu_pd(price + i + 2);
+			__m128d u01 = _mm_castsi128_pd(_mm_unpacklo_epi32(untaxed_mask, untaxed_mask));
+			__m128d u23 = _mm_castsi128_pd(_mm_unpackhi_epi32(untaxed_mask, untaxed_mask));
+			__m128d r01 = _mm_castsi128_pd(_mm_unpacklo_epi32(perishable_mask, perishable_mask));
+			__m128d r23 = _mm_castsi128_pd(_mm_unpackhi_epi32(perishable_mask, perishable_mask));
+
+			__m128d v01 = _mm_mul_pd(_mm_add_pd(_mm_andnot_pd(u01, _mm_mul_pd(p01, rate)), p01), q01);
+			__m128d v23 = _mm_mul_pd(_mm_add_pd(_mm_andnot_pd(u23, _mm_mul_pd(p23, rate)), p23), q23);
+			__m128d t01 = _mm_andnot_pd(u01, v01), x01 = _mm_and_pd(u01, v01);
+			__m128d t23 = _mm_andnot_pd(u23, v23), x23 = _mm_and_pd(u23, v23);
+			tn = _mm_add_pd(tn, _mm_add_pd(_mm_andnot_pd(r01, t01), _mm_andnot_pd(r23, t23)));
+			tp = _mm_add_pd(tp, _mm_add_pd(_mm_and_pd(r01, t01), _mm_and_pd(r23, t23)));
+			un = _mm_add_pd(un, _mm_add_pd(_mm_andnot_pd(r01, x01), _mm_andnot_pd(r23, x23)));
+			up = _mm_add_pd(up, _mm_add_pd(_mm_and_pd(r01, x01), _mm_and_pd(r23, x23)));
+		}
+		double lanes[2];
+		_mm_storeu_pd(lanes, tn);
+		sums[taxed_regular] += lanes[0] + lanes[1];
+		_mm_storeu_pd(lanes, un);
+		sums[untaxed_regular] += lanes[0] + lanes[1];
+		_mm_storeu_pd(lanes, tp);
+		sums[taxed_perishable] += lanes[0] + lanes[1];
+		_mm_storeu_pd(lanes, up);
+		sums[untaxed_perishable] += lanes[0] + lanes[1];
+#endif
+		//the remaining products (all of them without SSE2), without branches
+		for (; i < count; ++i) {
+			int category = (taxed[i] ? 0 : 1) + (type[i] == 'P' ? 2 : 0);
+			double cost = price[i] * TAX_RATE * (taxed[i] ? 1.0 : 0.0) + price[i];
+			sums[category] += cost * qty[i];
+		}
+	}
+
+	//Combines the four sums of the kernel into a Valuation.
+	static Valuation result(const double sums[categories])
+	{
+		Valuation value;
+		value.taxed = sums[taxed_regular] + sums[taxed_perishable];
+		value.untaxed = sums[untaxed_regular] + sums[untaxed_perishable];
+		value.regular = sums[taxed_regular] + sums[untaxed_regular];
+		value.perishable = sums[taxed_perishable] + sums[untaxed_perishable];
+		return value;
+	}
+
+	//This query returns the value of all the products.
+	double Valuation::total() const
+	{
+		return taxed + untaxed;
+	}
+
+	//This function returns the value of every product in the store.
+	Valuation valueInventory(const InventoryStore & store)
+	{
+		double sums[categories] = { 0.0, 0.0, 0.0, 0.0 };
+		if (!store.empty())
+			accumulate(store.types(), store.taxable(), store.prices(), store.quantities(), store.size(), sums);
+		return result(sums);
+	}
+
+	//This function returns the value of the products in the given rows of the store.
+	Valuation valueInventory(const InventoryStore & store, const size_t * rows, size_t count)
+	{
+		double sums[categories] = { 0.0, 0.0, 0.0, 0.0 };
+		char type[gather_rows];
+		unsigned char taxed[gather_rows];
+		double price[gather_rows];
+		int qty[gather_rows];
+
+		const char* types = store.types();
+		const unsigned char* taxable = store.taxable();
+		const double* prices = store.prices();
+		const int* quantities = store.quantities();
+		for (size_t first = 0; first < count; first += gather_rows) {
+			size_t block = count - first < gather_rows ? count - first : gather_rows;
+			for (size_t i = 0; i < block; ++i) {
+				size_t row = rows[first + i];
+				type[i] = types[row];
+				taxed[i] = taxable[row];
+				price[i] = prices[row];
+				qty[i] = quantities[row];
+			}
+			accumulate(type, taxed, price, qty, block, sums);
+		}
+		return result(sums);
+	}
+
+	//This function returns the value of every product of a published version, one page at a time.
+	Valuation valueInventory(const StockImage & image)
+	{
+		double sums[categories] = { 0.0, 0.0, 0.0, 0.0 };
+		for (size_t first = 0; first < image.rows; first += image_page_rows) {
+			const StockImage::Page& page = image.page(first);
+			size_t count = image.rows - first < image_page_rows ? image.rows - first : image_page_rows;
+			accumulate(page.types, page.taxable_flags, page.unit_prices, page.quantities_on_hand, count, sums);
+		}
+		return result(sums);
+	}
+}
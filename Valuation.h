@@ -0,0 +1,39 @@
+//Batch valuation of the products of an InventoryStore, straight from its columns.
+
+#ifndef GMS_Valuation_H
+#define GMS_Valuation_H
+
+#include "InventoryStore.h"
+
+namespace GMS {
+
+	class StockImage;
+
+	/*The value of a set of products: the cost of all units on hand (Product::total_cost, taxes included), split by
+	taxable status and by product type. Each product is counted once in taxed or untaxed, and once in regular ('N')
+	or perishable ('P'), so both pairs add up to the total.*/
+	struct Valuation {
+		double taxed;
+		double untaxed;
+		double regular;
+		double perishable;
+
+		//This query returns the value of all the products.
+		double total() const;
+	};
+
+	/*This function returns the value of every product in the store. It reads only the type, taxable, price and
+	quantity columns, several products at a time with SIMD instructions where the target supports them (SSE2), and
+	with a branch-free scalar loop otherwise. The unit cost of each product is computed exactly like Product::cost;
+	only the order of the additions differs from a product-by-product loop.*/
+	Valuation valueInventory(const InventoryStore& store);
+
+	/*This function returns the value of the products in the given rows of the store. A row that is listed twice is
+	counted twice. The rows are gathered in blocks and valued by the same kernel as the whole store.*/
+	Valuation valueInventory(const InventoryStore& store, const size_t* rows, size_t count);
+
+	//This function returns the value of every product of a published version of a store (see VersionedStore), page by
+	//page with the same kernel.
+	Valuation valueInventory(const StockImage& image);
+}
+#endif // !GMS_Valuation_H
@@ -0,0 +1,285 @@
+#include <cstring>
+#include <thread>
+#include <functional>
+#include "VersionedStore.h"
+
+namespace GMS {
+
+	StockImage::StockImage() : rows(0), number(0)
+	{
+	}
+
+	unsigned long long StockImage::version() const
+	{
+		return number;
+	}
+
+	size_t StockImage::size() const
+	{
+		return rows;
+	}
+
+	char StockImage::type(size_t row) const
+	{
+		return page(row).types[slot(row)];
+	}
+
+	const char * StockImage::sku(size_t row) const
+	{
+		return page(row).skus[slot(row)];
+	}
+
+	const char * StockImage::name(size_t row) const
+	{
+		const char* name = page(row).names[slot(row)];
+		return name[0] == '\0' ? nullptr : name;
+	}
+
+	const char * StockImage::unit(size_t row) const
+	{
+		return page(row).units[slot(row)];
+	}
+
+	bool StockImage::taxed(size_t row) const
+	{
+		return page(row).taxable_flags[slot(row)] != 0;
+	}
+
+	double StockImage::price(size_t row) const
+	{
+		return page(row).unit_prices[slot(row)];
+	}
+
+	double StockImage::cost(size_t row) const
+	{
+		const Page& p = page(row);
+		size_t i = slot(row);
+		if (p.taxable_flags[i])
+			return p.unit_prices[i] * TAX_RATE + p.unit_prices[i];
+		else
+			return p.unit_prices[i];
+	}
+
+	int StockImage::quantity(size_t row) const
+	{
+		return page(row).quantities_on_hand[slot(row)];
+	}
+
+	int StockImage::qtyNeeded(size_t row) const
+	{
+		return page(row).quantities_needed[slot(row)];
+	}
+
+	const Date & StockImage::expiry(size_t row) const
+	{
+		return page(row).expiry_dates[slot(row)];
+	}
+
+	double StockImage::total_cost(size_t row) const
+	{
+		return cost(row) * quantity(row);
+	}
+
+	double StockImage::total_cost() const
+	{
+		double total = 0.0;
+		for (size_t row = 0; row < rows; ++row)
+			total += total_cost(row);
+		return total;
+	}
+
+	//This constructor takes a free slot, announces the current epoch in it and pins the latest version.
+	VersionedStore::Reader::Reader(VersionedStore & store) : owner(store), slot(nullptr), image(nullptr)
+	{
+		size_t first = std::hash<std::thread::id>()(std::this_thread::get_id()) % owner.slot_count;
+		for (size_t attempt = 0; slot == nullptr; ++attempt) {
+			ReaderSlot& candidate = owner.slots[(first + attempt) % owner.slot_count];
+			unsigned long long free = 0;
+			//an epoch read before the slot is taken can only be older than the current one, which is safe: it keeps
+			//more versions alive, never fewer
+			if (candidate.epoch.load(std::memory_order_relaxed) == 0 &&
+				candidate.epoch.compare_exchange_strong(free, owner.epoch.load()))
+				slot = &candidate;
+			else if (attempt % owner.slot_count == owner.slot_count - 1)
+				std::this_thread::yield();
+		}
+		image = owner.latest.load();
+	}
+
+	//The destructor frees the slot, unpinning the version.
+	VersionedStore::Reader::~Reader()
+	{
+		slot->epoch.store(0, std::memory_order_release);
+	}
+
+	const StockImage & VersionedStore::Reader::operator*() const
+	{
+		return *image;
+	}
+
+	const StockImage * VersionedStore::Reader::operator->() const
+	{
+		return image;
+	}
+
+	//This constructor publishes the current contents of the store as the first version.
+	VersionedStore::VersionedStore(InventoryStore & store, size_t readers) : inventory(store), latest(nullptr), epoch(1),
+		slot_count(readers != 0 ? readers : 1)
+	{
+		slots.reset(new ReaderSlot[slot_count]);
+		for (size_t i = 0; i < slot_count; ++i)
+			slots[i].epoch.store(0, std::memory_order_relaxed);
+		dirty.assign((inventory.size() + image_page_rows - 1) >> image_page_shift, 1);
+		publish();
+	}
+
+	//The destructor frees every version.
+	VersionedStore::~VersionedStore()
+	{
+		for (const std::pair<unsigned long long, const StockImage*>& version : retired)
+			release(version.second);
+		release(latest.load());
+	}
+
+	//frees a version and the pages no other version shares
+	void VersionedStore::release(const StockImage * image)
+	{
+		if (image == nullptr)
+			return;
+		for (StockImage::Page* page : image->pages) {
+			if (--page->references == 0)
+				delete page;
+		}
+		delete image;
+	}
+
+	void VersionedStore::touch(size_t row)
+	{
+		size_t page = row >> image_page_shift;
+		if (page >= dirty.size())
+			dirty.resize(page + 1, 1);
+		dirty[page] = 1;
+	}
+
+	size_t VersionedStore::insert(const Product & product)
+	{
+		size_t row = inventory.insert(product);
+		touch(row);
+		return row;
+	}
+
+	size_t VersionedStore::insert(const Perishable & product)
+	{
+		size_t row = inventory.insert(product);
+		touch(row);
+		return row;
+	}
+
+	//Erasing moves the last row into the erased one, so both pages change.
+	void VersionedStore::erase(size_t row)
+	{
+		touch(inventory.size() - 1);
+		touch(row);
+		inventory.erase(row);
+	}
+
+	void VersionedStore::name(size_t row, const char * name)
+	{
+		inventory.name(row, name);
+		touch(row);
+	}
+
+	void VersionedStore::quantity(size_t row, int qtyOnHand)
+	{
+		inventory.quantity(row, qtyOnHand);
+		touch(row);
+	}
+
+	void VersionedStore::qtyNeeded(size_t row, int qtyNeeded)
+	{
+		inventory.qtyNeeded(row, qtyNeeded);
+		touch(row);
+	}
+
+	void VersionedStore::price(size_t row, double price)
+	{
+		inventory.price(row, price);
+		touch(row);
+	}
+
+	int VersionedStore::receive(size_t row, int units)
+	{
+		touch(row);
+		return inventory.receive(row, units);
+	}
+
+	/*This modifier publishes a new version: the pages that changed are copied from the columns of the store, the others
+	are shared with the previous version. The new version replaces the previous one in a single atomic store, after
+	which the previous one is retired in the current epoch and the epoch advances.*/
+	void VersionedStore::publish()
+	{
+		const StockImage* previous = latest.load(std::memory_order_relaxed);
+		StockImage* image = new StockImage();
+		image->rows = inventory.size();
+		image->number = previous != nullptr ? previous->number + 1 : 1;
+		size_t pageCount = (image->rows + image_page_rows - 1) >> image_page_shift;
+		image->pages.resize(pageCount);
+		dirty.resize(pageCount, 1);
+
+		for (size_t p = 0; p < pageCount; ++p) {
+			if (!dirty[p] && previous != nullptr && p < previous->pages.size() &&
+				(previous->rows >> image_page_shift) > p) {
+				//a full page of the previous version that did not change
+				image->pages[p] = previous->pages[p];
+				++image->pages[p]->references;
+				continue;
+			}
+			StockImage::Page* page = new StockImage::Page;
+			size_t first = p << image_page_shift;
+			size_t count = image->rows - first < image_page_rows ? image->rows - first : image_page_rows;
+			page->references = 1;
+			memcpy(page->types, &inventory.product_types[first], count);
+			memcpy(page->skus, &inventory.skus[first], count * sizeof(page->skus[0]));
+			memcpy(page->names, &inventory.names[first], count * sizeof(page->names[0]));
+			memcpy(page->units, &inventory.units[first], count * sizeof(page->units[0]));
+			memcpy(page->quantities_on_hand, &inventory.quantities_on_hand[first], count * sizeof(int));
+			memcpy(page->quantities_needed, &inventory.quantities_needed[first], count * sizeof(int));
+			memcpy(page->unit_prices, &inventory.unit_prices[first], count * sizeof(double));
+			memcpy(page->taxable_flags, &inventory.taxable_flags[first], count);
+			std::copy(inventory.expiry_dates.begin() + first, inventory.expiry_dates.begin() + first + count,
+				page->expiry_dates);
+			image->pages[p] = page;
+			dirty[p] = 0;
+		}
+
+		latest.store(image);
+		if (previous != nullptr)
+			retired.push_back(std::make_pair(epoch.fetch_add(1), previous));
+		reclaim();
+	}
+
+	//This modifier frees the versions retired before the oldest epoch announced by an open Reader.
+	size_t VersionedStore::reclaim()
+	{
+		unsigned long long oldest = ~0ULL;
+		for (size_t i = 0; i < slot_count; ++i) {
+			unsigned long long announced = slots[i].epoch.load();
+			if (announced != 0 && announced < oldest)
+				oldest = announced;
+		}
+		size_t kept = 0;
+		for (size_t i = 0; i < retired.size(); ++i) {
+			if (retired[i].first < oldest)
+				release(retired[i].second);
+			else
+				retired[kept++] = retired[i];
+		}
+		retired.resize(kept);
+		return kept;
+	}
+
+	unsigned long long VersionedStore::version() const
+	{
+		return latest.load()->number;
+	}
+}
@@ -0,0 +1,175 @@
+//The VersionedStore class publishes immutable point-in-time versions of an InventoryStore (StockImages), which any
+//number of threads can read without locks while the store keeps being updated.
+
+#ifndef GMS_VersionedStore_H
+#define GMS_VersionedStore_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include "InventoryStore.h"
+#include "Valuation.h"
+
+namespace GMS {
+
+	class VersionedStore;
+
+	//the number of rows of a page of a StockImage (a power of two)
+	const size_t image_page_shift = 10;
+	const size_t image_page_rows = size_t(1) << image_page_shift;
+
+	/*A StockImage is a version of the store: the products exactly as they were when the version was published. It is
+	never changed once published. The rows are split into pages of image_page_rows rows, each holding the columns of its
+	rows; a version shares every page it did not change with the version before it (copy-on-write), so publishing
+	costs a copy of the changed pages only.*/
+	class StockImage {
+
+		struct Page {
+			//the number of versions that share the page (only the writer changes it)
+			size_t references;
+			char types[image_page_rows];
+			char skus[image_page_rows][max_sku_length + 1];
+			const char* names[image_page_rows];
+			char units[image_page_rows][max_unit_length + 1];
+			int quantities_on_hand[image_page_rows];
+			int quantities_needed[image_page_rows];
+			double unit_prices[image_page_rows];
+			unsigned char taxable_flags[image_page_rows];
+			Date expiry_dates[image_page_rows];
+		};
+
+		std::vector<Page*> pages;
+		size_t rows;
+		unsigned long long number;
+
+		friend class VersionedStore;
+		friend Valuation valueInventory(const StockImage& image);
+
+		StockImage();
+
+		//the page holding the row, and the index of the row in its page
+		const Page& page(size_t row) const { return *pages[row >> image_page_shift]; }
+		static size_t slot(size_t row) { return row & (image_page_rows - 1); }
+
+	public:
+
+		StockImage(const StockImage&) = delete;
+		StockImage& operator=(const StockImage&) = delete;
+
+		//This query returns the number of the version: 1 for the first version published, then 2, 3, ...
+		unsigned long long version() const;
+
+		//This query returns the number of products in the version.
+		size_t size() const;
+
+		//row queries, with the same results as the InventoryStore queries of the same name had at publication
+		char type(size_t row) const;
+		const char* sku(size_t row) const;
+		//returns nullptr if the product has no name, like Product::name()
+		const char* name(size_t row) const;
+		const char* unit(size_t row) const;
+		bool taxed(size_t row) const;
+		double price(size_t row) const;
+		double cost(size_t row) const;
+		int quantity(size_t row) const;
+		int qtyNeeded(size_t row) const;
+		const Date& expiry(size_t row) const;
+		double total_cost(size_t row) const;
+
+		//This query returns the total cost of all units on hand of all products, taxes included.
+		double total_cost() const;
+	};
+
+	/*A VersionedStore has a single writer: the thread that changes the store (through the modifiers below, which
+	record which pages they change) and calls publish to make its changes visible as a new version. Readers, on any
+	number of threads, open a Reader, which pins the latest published version until it is closed: nothing the writer
+	does afterwards changes what the Reader sees, and neither side ever waits for the other.
+
+	Versions are reclaimed by epochs. A Reader announces the epoch it started in, in a slot of its own, before it looks
+	up the latest version. publish replaces the latest version, retires the previous one with the current epoch and
+	advances the epoch; a retired version is freed (with the pages no other version shares) as soon as no Reader
+	announced an epoch up to the one it was retired in, because only those Readers can still be looking at it. A Reader
+	that stays open therefore keeps its version, and the versions retired after it, alive.
+
+	Changes made to the store without the modifiers below must be reported with touch before the next publish. The
+	store must not be cleared, and no mapping it borrows names from released, while any version is alive: versions
+	share the names of the store.*/
+	class VersionedStore {
+
+		struct alignas(64) ReaderSlot {
+			//the epoch announced by the Reader using the slot, or zero when the slot is free
+			std::atomic<unsigned long long> epoch;
+		};
+
+		InventoryStore& inventory;
+		std::atomic<const StockImage*> latest;
+		std::atomic<unsigned long long> epoch;
+		std::unique_ptr<ReaderSlot[]> slots;
+		size_t slot_count;
+		//one flag per page of the store: set when a row of the page has changed since the last publish
+		std::vector<unsigned char> dirty;
+		//the versions replaced by publish, each with the epoch it was retired in
+		std::vector<std::pair<unsigned long long, const StockImage*>> retired;
+
+		//frees a version and the pages no other version shares
+		static void release(const StockImage* image);
+
+	public:
+
+		//the number of Readers that can be open at the same time when none is given
+		static const size_t default_readers = 64;
+
+		/*A Reader pins the latest published version while it is open. It is meant to be short-lived and used by a
+		single thread; opening a Reader waits (yielding) only if every reader slot is taken.*/
+		class Reader {
+
+			VersionedStore& owner;
+			ReaderSlot* slot;
+			const StockImage* image;
+
+		public:
+
+			explicit Reader(VersionedStore& store);
+			Reader(const Reader&) = delete;
+			Reader& operator=(const Reader&) = delete;
+			~Reader();
+
+			const StockImage& operator*() const;
+			const StockImage* operator->() const;
+		};
+
+		/*This constructor creates the versioned store of the referenced store, with room for the given number of open
+		Readers, and publishes its current contents as the first version.*/
+		explicit VersionedStore(InventoryStore& store, size_t readers = default_readers);
+		VersionedStore(const VersionedStore&) = delete;
+		VersionedStore& operator=(const VersionedStore&) = delete;
+
+		//The destructor frees every version; no Reader may be open.
+		~VersionedStore();
+
+		//These modifiers change the store like the InventoryStore modifiers of the same name.
+		size_t insert(const Product& product);
+		size_t insert(const Perishable& product);
+		void erase(size_t row);
+		void name(size_t row, const char* name);
+		void quantity(size_t row, int qtyOnHand);
+		void qtyNeeded(size_t row, int qtyNeeded);
+		void price(size_t row, double price);
+		int receive(size_t row, int units);
+
+		//This modifier records that the given row has been changed directly in the store.
+		void touch(size_t row);
+
+		/*This modifier publishes the current contents of the store as a new version, copying the pages that changed
+		since the last one, and frees the retired versions no Reader can see any more.*/
+		void publish();
+
+		//This modifier frees the retired versions no Reader can see any more and returns the number still retired.
+		size_t reclaim();
+
+		//This query returns the number of the latest published version.
+		unsigned long long version() const;
+	};
+}
+#endif // !GMS_VersionedStore_H
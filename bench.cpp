@@ -0,0 +1,669 @@
+// bench times the main product operations on synthetic catalogs and prints one
+// CSV line per measurement, so that runs can be compared by a script:
+//
+//   benchmark,products,operations,seconds,ns_per_op
+//
+// The catalogs are made by a deterministic generator: the same seed and size
+// always give the same records, on every platform.
+//
+// usage: bench [-n products[,products...]] [-r repeats] [-s seed] [-f file]
+//        bench -g products file [seed]     (only write a generated product file)
+//
+// The default sizes are 10000, 1000000 and 10000000 products. Each benchmark
+// runs repeats times (default 3) and the fastest run is reported.
+#include <iostream>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "iProduct.h"
+#include "Product.h"
+#include "Perishable.h"
+#include "Date.h"
+#include "InventoryStore.h"
+#include "MappedLoader.h"
+#include "ImportPipeline.h"
+#include "Valuation.h"
+#include "ReportWriter.h"
+#include "RecordWriter.h"
+#include "Journal.h"
+#include "VersionedStore.h"
+#include "StockMoves.h"
+#include "Snapshot.h"
+#include "Catalog.h"
+using namespace std;
+using namespace GMS;
+
+// splitmix64: a small generator whose output is fully defined by its seed
+struct Random {
+  unsigned long long state;
+  explicit Random(unsigned long long seed) : state(seed) {}
+  unsigned long long next() {
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+  unsigned below(unsigned bound) { return (unsigned)(next() % bound); }
+};
+
+// makes the i-th sku as a base-36 number, so that every sku is unique
+void makeSku(char* sku, unsigned long long i) {
+  const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  int len = 0;
+  do {
+    sku[len++] = digits[i % 36];
+    i /= 36;
+  } while (i != 0 && len < max_sku_length);
+  sku[len] = '\0';
+}
+
+// writes the i-th generated record, in the format of Product::store and
+// Perishable::store, to the buffer and returns its length
+int makeRecord(char* line, size_t size, unsigned long long i, Random& random, unsigned perishablePercent) {
+  static const char* const names[] = { "apple", "box", "water", "milk", "bread", "rice", "soap", "paper",
+    "coffee", "tea", "sugar", "salt", "juice", "cereal", "cheese", "yogurt" };
+  static const char* const units[] = { "kg", "liter", "pack", "box", "unit", "bottle" };
+  char sku[max_sku_length + 1];
+  makeSku(sku, i);
+  bool perishable = random.below(100) < perishablePercent;
+  const char* name = names[random.below(16)];
+  unsigned variant = random.below(1000);
+  const char* unit = units[random.below(6)];
+  int taxed = (int)random.below(2);
+  double price = (1 + random.below(99999)) / 100.0;
+  int quantity = (int)random.below(200);
+  int needed = (int)random.below(200);
+  int length = snprintf(line, size, "%c,%s,%s%u,%s,%d,%g,%d,%d", perishable ? 'P' : 'N', sku, name, variant,
+    unit, taxed, price, quantity, needed);
+  if (perishable)
+    length += snprintf(line + length, size - length, ",%d/%02d/%02d", 2018 + (int)random.below(12),
+      1 + (int)random.below(12), 1 + (int)random.below(28));
+  line[length++] = '\n';
+  return length;
+}
+
+// writes a product file of the given number of generated records
+bool generate(const char* filename, unsigned long long products, unsigned long long seed,
+  unsigned perishablePercent) {
+  FILE* file = fopen(filename, "wb");
+  if (file == nullptr)
+    return false;
+  Random random(seed);
+  char line[160];
+  for (unsigned long long i = 0; i < products; i++) {
+    int length = makeRecord(line, sizeof(line) - 1, i, random, perishablePercent);
+    fwrite(line, 1, (size_t)length, file);
+  }
+  return fclose(file) == 0;
+}
+
+// a stream buffer that discards its output
+class NullBuffer : public streambuf {
+  char buffer[4096];
+protected:
+  int overflow(int c) {
+    setp(buffer, buffer + sizeof(buffer));
+    return c == EOF ? 0 : c;
+  }
+public:
+  NullBuffer() { setp(buffer, buffer + sizeof(buffer)); }
+};
+
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* benchmark, unsigned long long products, unsigned long long operations, double seconds) {
+  printf("%s,%llu,%llu,%.6f,%.1f\n", benchmark, products, operations, seconds,
+    operations != 0 ? seconds * 1e9 / (double)operations : 0.0);
+  fflush(stdout);
+}
+
+void release(vector<iProduct*>& products) {
+  for (size_t i = 0; i < products.size(); i++)
+    delete products[i];
+  products.clear();
+}
+
+// keeps the optimizer from discarding the results that are timed
+volatile double sink;
+
+// runs every benchmark on a catalog of the given size
+void run(unsigned long long n, int repeats, unsigned long long seed, const string& file) {
+  string plain = file + ".n";
+  if (!generate(file.c_str(), n, seed, 30) || !generate(plain.c_str(), n, seed, 0)) {
+    cerr << "bench: cannot write " << file << endl;
+    exit(1);
+  }
+  double best;
+  chrono::steady_clock::time_point start;
+  vector<iProduct*> products;
+  InventoryStore store;
+
+  // load: Product::load through an fstream, the way the application reads its file (the file
+  // holds only N records: Perishable::load reads past the end of its own record)
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    fstream in(plain.c_str(), ios::in);
+    Product product;
+    unsigned long long records = 0;
+    start = chrono::steady_clock::now();
+    while (in.get() == 'N' && in.get() == ',') {
+      product.load(in);
+      records++;
+    }
+    double seconds = secondsSince(start);
+    if (records != n)
+      cerr << "bench: load_fstream read " << records << " records" << endl;
+    best = min(best, seconds);
+  }
+  report("load_fstream", n, n, best);
+
+  // load: the mapped loaders, into objects and into a store
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    release(products);
+    start = chrono::steady_clock::now();
+    loadMapped(file.c_str(), products);
+    best = min(best, secondsSince(start));
+  }
+  report("load_mapped_objects", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    store.clear();
+    start = chrono::steady_clock::now();
+    loadMapped(file.c_str(), store);
+    best = min(best, secondsSince(start));
+  }
+  report("load_mapped_store", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    store.clear();
+    start = chrono::steady_clock::now();
+    loadParallel(file.c_str(), store);
+    best = min(best, secondsSince(start));
+  }
+  report("load_parallel_store", n, n, best);
+
+  // load: the import pipeline, with the work time of each of its stages
+  best = 1e300;
+  PipelineStats stages = PipelineStats();
+  for (int r = 0; r < repeats; r++) {
+    store.clear();
+    PipelineStats run;
+    start = chrono::steady_clock::now();
+    loadPipelined(file.c_str(), store, 0, &run);
+    double seconds = secondsSince(start);
+    if (seconds < best) {
+      best = seconds;
+      stages = run;
+    }
+  }
+  report("load_pipelined_store", n, n, best);
+  report("load_pipelined_read_busy", n, n, stages.read.busy);
+  report("load_pipelined_parse_busy", n, n, stages.parse.busy);
+  report("load_pipelined_insert_busy", n, n, stages.insert.busy);
+
+  // store: iProduct::store of every object
+  string stored = file + ".out";
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    fstream out(stored.c_str(), ios::out | ios::trunc);
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < products.size(); i++)
+      products[i]->store(out);
+    out.flush();
+    best = min(best, secondsSince(start));
+  }
+  report("store_fstream", n, n, best);
+
+  // store: the same records through a RecordWriter, written in large blocks and forced to disk once
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    if (!saveRecords(stored.c_str(), products.data(), products.size()))
+      cerr << "bench: cannot save " << stored << endl;
+    best = min(best, secondsSince(start));
+  }
+  report("store_records", n, n, best);
+
+  // cold start files: a binary snapshot and a compressed catalog of the store, saved and loaded back, and single
+  // products looked up in the catalog through a newly opened reader, in a pseudo-random order
+  {
+    string snapshot = stored + ".snapshot";
+    string catalog = stored + ".catalog";
+    InventoryStore loaded;
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      if (!saveSnapshot(snapshot.c_str(), store))
+        cerr << "bench: cannot save " << snapshot << endl;
+      best = min(best, secondsSince(start));
+    }
+    report("snapshot_save", n, n, best);
+
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      if (!restoreSnapshot(snapshot.c_str(), loaded))
+        cerr << "bench: cannot restore " << snapshot << endl;
+      best = min(best, secondsSince(start));
+    }
+    report("snapshot_restore", n, n, best);
+
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      if (!saveCatalog(catalog.c_str(), store))
+        cerr << "bench: cannot save " << catalog << endl;
+      best = min(best, secondsSince(start));
+    }
+    report("catalog_save", n, n, best);
+
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      if (!loadCatalog(catalog.c_str(), loaded))
+        cerr << "bench: cannot load " << catalog << endl;
+      best = min(best, secondsSince(start));
+    }
+    report("catalog_load", n, n, best);
+
+    unsigned long long lookups = n < 100000 ? n : 100000;
+    char code[max_sku_length + 1];
+    ProductRecord record;
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      Random random(seed + 1);
+      unsigned long long found = 0;
+      start = chrono::steady_clock::now();
+      CatalogReader reader;
+      reader.open(catalog.c_str());
+      for (unsigned long long i = 0; i < lookups; i++) {
+        makeSku(code, random.next() % n);
+        found += reader.find(code, record);
+      }
+      best = min(best, secondsSince(start));
+      if (found != lookups)
+        cerr << "bench: catalog_find missed " << lookups - found << " skus" << endl;
+    }
+    report("catalog_find", n, lookups, best);
+    remove(snapshot.c_str());
+    remove(catalog.c_str());
+  }
+
+  // journal: durable receipts appended to a journal of the saved file, committed one by one and in groups of 64
+  {
+    string journal = stored + ".journal";
+    char code[max_sku_length + 1];
+    for (size_t group = 1; group <= 64; group *= 64) {
+      unsigned long long updates = group == 1 ? 1000 : 64000;
+      best = 1e300;
+      for (int r = 0; r < repeats; r++) {
+        remove(journal.c_str());
+        InventoryStore journaled;
+        Journal changes(journaled, group);
+        if (!changes.open(stored.c_str()))
+          cerr << "bench: cannot open the journal of " << stored << endl;
+        start = chrono::steady_clock::now();
+        for (unsigned long long i = 0; i < updates; i++) {
+          makeSku(code, i % n);
+          changes.receive(code, 1);
+        }
+        changes.commit();
+        best = min(best, secondsSince(start));
+      }
+      report(group == 1 ? "journal_receive_commit" : "journal_receive_group64", n, updates, best);
+    }
+    remove(journal.c_str());
+  }
+  remove(stored.c_str());
+
+  // write: linear display of every object
+  NullBuffer discard;
+  ostream null(&discard);
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < products.size(); i++)
+      products[i]->write(null, true);
+    best = min(best, secondsSince(start));
+  }
+  report("write_linear", n, n, best);
+
+  // write: the same lines through a ReportWriter, from the objects and from the store
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    {
+      ReportWriter writer(null);
+      for (size_t i = 0; i < products.size(); i++)
+        writer.write(*products[i]);
+    }
+    best = min(best, secondsSince(start));
+  }
+  report("write_report_objects", n, n, best);
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    {
+      ReportWriter writer(null);
+      writer.write(store);
+    }
+    best = min(best, secondsSince(start));
+  }
+  report("write_report_store", n, n, best);
+
+  // read: the console entry of every object, from a prepared stream (the prompts are discarded)
+  {
+    stringstream input;
+    for (size_t i = 0; i < products.size(); i++) {
+      Perishable* perishable = dynamic_cast<Perishable*>(products[i]);
+      input << "SKU" << i % 10000 << '\n' << "name" << i % 1000 << '\n' << "kg\ny\n" << 1 + i % 100 << ".25\n"
+        << i % 50 << '\n' << i % 20 << '\n';
+      if (perishable != nullptr)
+        input << "2020/01/" << 1 + i % 28 << '\n';
+    }
+    string text = input.str();
+    best = 1e300;
+    streambuf* console = cout.rdbuf(&discard);
+    for (int r = 0; r < repeats; r++) {
+      istringstream in(text);
+      start = chrono::steady_clock::now();
+      for (size_t i = 0; i < products.size(); i++)
+        products[i]->read(in);
+      best = min(best, secondsSince(start));
+    }
+    cout.rdbuf(console);
+  }
+  report("read_console", n, n, best);
+
+  // sku lookup through the store's index, in a pseudo-random order
+  unsigned long long lookups = n < 1000000 ? n : 1000000;
+  char sku[max_sku_length + 1];
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    Random random(seed + 1);
+    unsigned long long found = 0;
+    start = chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < lookups; i++) {
+      makeSku(sku, random.next() % n);
+      found += store.find(sku) != InventoryStore::npos;
+    }
+    best = min(best, secondsSince(start));
+    if (found != lookups)
+      cerr << "bench: sku_find missed " << lookups - found << " skus" << endl;
+  }
+  report("sku_find", n, lookups, best);
+
+  // receiving: one lookup and one update per movement, against a batch grouped by sku
+  {
+    vector<StockMove> moves(lookups);
+    Random random(seed + 5);
+    for (unsigned long long i = 0; i < lookups; i++) {
+      makeSku(sku, random.next() % n);
+      moves[i] = StockMove(StockMove::receipt, sku, 1 + (int)(random.next() % 10));
+    }
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      for (unsigned long long i = 0; i < lookups; i++) {
+        size_t row = store.find(moves[i].sku);
+        if (row != InventoryStore::npos)
+          store.receive(row, moves[i].units);
+      }
+      best = min(best, secondsSince(start));
+    }
+    report("receive_each", n, lookups, best);
+
+    vector<MoveResult> results;
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      start = chrono::steady_clock::now();
+      applyMoves(store, moves, results);
+      best = min(best, secondsSince(start));
+    }
+    report("receive_batch", n, lookups, best);
+  }
+
+  // products to reorder: a scan of every object against the store's reorder set
+  best = 1e300;
+  vector<size_t> short_rows;
+  for (int r = 0; r < repeats; r++) {
+    vector<const iProduct*> needing;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < products.size(); i++)
+      if (products[i]->quantity() < products[i]->qtyNeeded())
+        needing.push_back(products[i]);
+    best = min(best, secondsSince(start));
+    short_rows.resize(needing.size());
+  }
+  report("reorder_scan", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    short_rows.clear();
+    start = chrono::steady_clock::now();
+    store.reorder(short_rows);
+    sink = (double)store.total_shortfall();
+    best = min(best, secondsSince(start));
+  }
+  report("reorder_set", n, short_rows.size(), best);
+
+  // listing by name: a comparison sort of the objects (strcmp through the virtual name()) against the store's
+  // name index, and a prefix search
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    vector<const iProduct*> listing(products.begin(), products.end());
+    start = chrono::steady_clock::now();
+    sort(listing.begin(), listing.end(),
+         [](const iProduct* a, const iProduct* b) { return strcmp(a->name(), b->name()) < 0; });
+    best = min(best, secondsSince(start));
+  }
+  report("name_sort_objects", n, n, best);
+
+  store.sortNames();
+  vector<size_t> name_rows;
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    name_rows.clear();
+    start = chrono::steady_clock::now();
+    store.byName(name_rows);
+    best = min(best, secondsSince(start));
+  }
+  report("name_index_rows", n, name_rows.size(), best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    name_rows.clear();
+    start = chrono::steady_clock::now();
+    store.nameStarting("soap1", name_rows);
+    best = min(best, secondsSince(start));
+  }
+  report("name_prefix", n, name_rows.size(), best);
+
+  // substring search: strstr over every object, building the store's trigram index, and searching it
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    size_t matches = 0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < products.size(); i++)
+      matches += strstr(products[i]->name(), "ice70") != nullptr;
+    best = min(best, secondsSince(start));
+    name_rows.resize(matches);
+  }
+  report("substring_scan", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    store.indexSubstrings();
+    best = min(best, secondsSince(start));
+  }
+  report("substring_index_build", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    name_rows.clear();
+    start = chrono::steady_clock::now();
+    store.nameContaining("ice70", name_rows);
+    best = min(best, secondsSince(start));
+  }
+  report("substring_index", n, name_rows.size(), best);
+
+  // total cost aggregation: virtual calls, the store's column loop and the batch valuation
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    double total = 0.0;
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < products.size(); i++)
+      total += *products[i];
+    best = min(best, secondsSince(start));
+    sink = total;
+  }
+  report("total_cost_virtual", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    sink = store.total_cost();
+    best = min(best, secondsSince(start));
+  }
+  report("total_cost_store", n, n, best);
+
+  best = 1e300;
+  for (int r = 0; r < repeats; r++) {
+    start = chrono::steady_clock::now();
+    sink = valueInventory(store).total();
+    best = min(best, secondsSince(start));
+  }
+  report("total_cost_valuation", n, n, best);
+
+  // the running total after a price change, against recomputing it with the column loop
+  {
+    Random random(seed + 4);
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      size_t row = random.next() % n;
+      start = chrono::steady_clock::now();
+      store.price(row, store.price(row) + 0.01);
+      sink = store.value();
+      best = min(best, secondsSince(start));
+    }
+    report("total_cost_running", n, 1, best);
+  }
+
+  // versions: publishing a version of the store after 100 price changes, and valuing a published version
+  {
+    VersionedStore versions(store);
+    Random random(seed + 3);
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      for (int i = 0; i < 100; i++) {
+        size_t row = random.next() % n;
+        versions.price(row, store.price(row) + 0.01);
+      }
+      start = chrono::steady_clock::now();
+      versions.publish();
+      best = min(best, secondsSince(start));
+    }
+    report("version_publish_100", n, 1, best);
+
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      VersionedStore::Reader version(versions);
+      start = chrono::steady_clock::now();
+      sink = valueInventory(*version).total();
+      best = min(best, secondsSince(start));
+    }
+    report("total_cost_version", n, n, best);
+  }
+
+  // Date parsing: Date::read of one date per product
+  {
+    Random random(seed + 2);
+    string text;
+    char date[16];
+    for (unsigned long long i = 0; i < n; i++) {
+      snprintf(date, sizeof(date), "%d/%02d/%02d\n", 2018 + (int)random.below(12), 1 + (int)random.below(12),
+        1 + (int)random.below(28));
+      text += date;
+    }
+    best = 1e300;
+    for (int r = 0; r < repeats; r++) {
+      istringstream in(text);
+      Date parsed;
+      int errors = 0;
+      start = chrono::steady_clock::now();
+      for (unsigned long long i = 0; i < n; i++) {
+        parsed.read(in);
+        errors += parsed.bad();
+      }
+      best = min(best, secondsSince(start));
+      sink = errors;
+    }
+  }
+  report("date_read", n, n, best);
+
+  release(products);
+  store.clear();
+  remove(file.c_str());
+  remove(plain.c_str());
+}
+
+int main(int argc, char* argv[]) {
+  vector<unsigned long long> sizes;
+  int repeats = 3;
+  unsigned long long seed = 20180408;
+  string file = "bench_products.txt";
+
+  if (argc >= 4 && strcmp(argv[1], "-g") == 0) {
+    unsigned long long seed_ = argc > 4 ? strtoull(argv[4], nullptr, 10) : seed;
+    return generate(argv[3], strtoull(argv[2], nullptr, 10), seed_, 30) ? 0 : 1;
+  }
+  for (int i = 1; i < argc; i++) {
+    string option = argv[i];
+    if (i + 1 >= argc) {
+      cerr << "usage: bench [-n products[,products...]] [-r repeats] [-s seed] [-f file]" << endl
+        << "       bench -g products file [seed]" << endl;
+      return 1;
+    }
+    const char* value = argv[++i];
+    if (option == "-n") {
+      for (const char* p = value; *p != '\0'; ) {
+        char* end;
+        unsigned long long size = strtoull(p, &end, 10);
+        if (end == p)
+          break;
+        sizes.push_back(size);
+        p = *end == ',' ? end + 1 : end;
+      }
+    }
+    else if (option == "-r")
+      repeats = atoi(value) > 0 ? atoi(value) : 1;
+    else if (option == "-s")
+      seed = strtoull(value, nullptr, 10);
+    else if (option == "-f")
+      file = value;
+  }
+  if (sizes.empty()) {
+    sizes.push_back(10000);
+    sizes.push_back(1000000);
+    sizes.push_back(10000000);
+  }
+
+  printf("benchmark,products,operations,seconds,ns_per_op\n");
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] != 0)
+      run(sizes[i], repeats, seed, file);
+  }
+  return 0;
+}
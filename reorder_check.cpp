@@ -0,0 +1,150 @@
+// reorder_check runs random mixes of inserts, erasures and quantity, needed quantity and
+// price changes (through the store modifiers, assign and ProductView) against an
+// InventoryStore, and after every batch checks what the store keeps up to date against a
+// scan of every row:
+//
+//   - the reorder set (reorder, reorderCount) and total_shortfall,
+//   - the order of reorder with largestFirst (largest shortfall first, ties in row order),
+//   - the running totals: value, taxed_value, untaxed_value and total_quantity.
+//
+// It then changes quantities through a ConcurrentStock, which bypasses the reorder set and
+// the running totals, and checks them again after InventoryStore::resync.
+//
+// It prints one summary line and exits with a non-zero status if any check failed.
+//
+// usage: reorder_check [operations] [seed]
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "InventoryStore.h"
+#include "ConcurrentStock.h"
+#include "Product.h"
+#include "Perishable.h"
+using namespace std;
+using namespace GMS;
+
+// a small xorshift generator
+struct Random {
+  unsigned long long state;
+  explicit Random(unsigned long long seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+  unsigned next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned)(state >> 32);
+  }
+};
+
+bool agree(double a, double b) {
+  return fabs(a - b) <= 1e-9 * (1 + fabs(a) + fabs(b));
+}
+
+// returns the number of the checks below that fail
+int check(const InventoryStore& store) {
+  int failures = 0;
+  vector<size_t> scanned, kept;
+  long long shortfall = 0, units = 0;
+  double value = 0, taxed = 0, untaxed = 0;
+  for (size_t row = 0; row < store.size(); row++) {
+    if (store.quantity(row) < store.qtyNeeded(row)) {
+      scanned.push_back(row);
+      shortfall += store.qtyNeeded(row) - store.quantity(row);
+    }
+    units += store.quantity(row);
+    value += store.total_cost(row);
+    (store.taxed(row) ? taxed : untaxed) += store.total_cost(row);
+  }
+
+  store.reorder(kept);
+  sort(kept.begin(), kept.end());
+  failures += kept != scanned;
+  failures += store.reorderCount() != scanned.size();
+  failures += store.total_shortfall() != shortfall;
+
+  vector<size_t> largest;
+  store.reorder(largest, true);
+  vector<size_t> expected = scanned;
+  stable_sort(expected.begin(), expected.end(), [&](size_t a, size_t b) {
+    return store.shortfall(a) > store.shortfall(b);
+  });
+  failures += largest != expected;
+
+  failures += store.total_quantity() != units;
+  failures += !agree(store.value(), value);
+  failures += !agree(store.taxed_value(), taxed);
+  failures += !agree(store.untaxed_value(), untaxed);
+  return failures;
+}
+
+int main(int argc, char* argv[]) {
+  size_t operations = argc > 1 ? (size_t)atol(argv[1]) : 200000;
+  unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 4;
+
+  InventoryStore store;
+  Random random(seed);
+  char sku[max_sku_length + 1];
+  int failures = 0;
+  size_t checks = 0;
+  for (size_t i = 0; i < operations; i++) {
+    unsigned op = random.next() % 10;
+    snprintf(sku, sizeof(sku), "%u", random.next() % 3000);
+    if (op == 0 || store.size() == 0) {
+      store.insert(random.next() % 2 ? 'N' : 'P', sku, "name", "unit", random.next() % 2 != 0,
+        (random.next() % 10000) / 100.0, random.next() % 50, random.next() % 50,
+        Date(2020, 1, 1 + random.next() % 28));
+    }
+    else {
+      size_t row = random.next() % store.size();
+      int amount = (int)(random.next() % 50);
+      switch (op) {
+      case 1:
+        if (random.next() % 4 == 0)
+          store.erase(row);
+        break;
+      case 2: store.quantity(row, amount); break;
+      case 3: store.qtyNeeded(row, amount); break;
+      case 4: store.receive(row, amount - 10); break;
+      case 5: store.price(row, (random.next() % 10000) / 100.0); break;
+      case 6: {
+        Product product(sku, "assigned", "unit", amount, random.next() % 2 != 0, 2.5, (int)(random.next() % 50));
+        store.assign(row, product);
+        break;
+      }
+      case 7: {
+        Perishable product;
+        store.assign(row, product);
+        store.quantity(row, amount);
+        break;
+      }
+      case 8: store.view(row) += amount - 10; break;
+      default: store.view(row).quantity(amount); break;
+      }
+    }
+    if (i % 5000 == 4999) {
+      failures += check(store);
+      checks++;
+    }
+  }
+  failures += check(store);
+  checks++;
+
+  {
+    ConcurrentStock stock(store);
+    for (size_t i = 0; i < operations / 10 && store.size() != 0; i++) {
+      size_t row = random.next() % store.size();
+      if (random.next() % 2)
+        stock.receive(row, (int)(random.next() % 20));
+      else
+        stock.sell(row, (int)(random.next() % 20));
+    }
+  }
+  store.resync();
+  failures += check(store);
+  checks++;
+
+  printf("reorder_check: %s, %zu operations, %zu checks, %zu rows, %zu to reorder, %d failures\n",
+    failures == 0 ? "ok" : "FAILED", operations, checks, store.size(), store.reorderCount(), failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+// roundtrip_check fills an InventoryStore with random products (regular and perishable,
+// with and without expiry dates, prices that are and are not a whole number of cents,
+// shared, empty and long names), saves it as a snapshot and as a catalog, loads both
+// back and compares every product with the original, field by field: type, sku, name,
+// unit, taxable flag, price (bit for bit), both quantities and expiry date. It also looks
+// up every sku with a CatalogReader, and checks that a catalog with a damaged block fails
+// to load and leaves the store empty.
+//
+// It prints one summary line and exits with a non-zero status if any check failed.
+//
+// usage: roundtrip_check [products] [seed]
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "InventoryStore.h"
+#include "ProductRecord.h"
+#include "Snapshot.h"
+#include "Catalog.h"
+using namespace std;
+using namespace GMS;
+
+// a small xorshift generator
+struct Random {
+  unsigned long long state;
+  explicit Random(unsigned long long seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+  unsigned next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned)(state >> 32);
+  }
+};
+
+// the name of a row, with no name read as the empty name
+const char* nameOf(const char* name) {
+  return name != nullptr ? name : "";
+}
+
+bool sameDate(const Date& a, const Date& b) {
+  return a.key() == b.key();
+}
+
+// returns true if row b of store b holds exactly the product in row a of store a
+bool same(const InventoryStore& a, size_t rowA, const InventoryStore& b, size_t rowB) {
+  double priceA = a.price(rowA), priceB = b.price(rowB);
+  return a.type(rowA) == b.type(rowB) && strcmp(a.sku(rowA), b.sku(rowB)) == 0 &&
+    strcmp(nameOf(a.name(rowA)), nameOf(b.name(rowB))) == 0 && strcmp(a.unit(rowA), b.unit(rowB)) == 0 &&
+    a.taxed(rowA) == b.taxed(rowB) && memcmp(&priceA, &priceB, sizeof(double)) == 0 &&
+    a.quantity(rowA) == b.quantity(rowB) && a.qtyNeeded(rowA) == b.qtyNeeded(rowB) &&
+    sameDate(a.expiry(rowA), b.expiry(rowB));
+}
+
+// returns true if the record holds exactly the product in the row of the store
+bool same(const InventoryStore& store, size_t row, const ProductRecord& record) {
+  double price = store.price(row);
+  string name(record.name, record.name_length);
+  return store.type(row) == record.type && strcmp(store.sku(row), record.sku) == 0 &&
+    name == nameOf(store.name(row)) && strcmp(store.unit(row), record.unit) == 0 &&
+    store.taxed(row) == record.taxed && memcmp(&price, &record.price, sizeof(double)) == 0 &&
+    store.quantity(row) == record.quantity && store.qtyNeeded(row) == record.needed &&
+    sameDate(store.expiry(row), record.expiry);
+}
+
+int main(int argc, char* argv[]) {
+  size_t products = argc > 1 ? (size_t)atol(argv[1]) : 50000;
+  unsigned seed = argc > 2 ? (unsigned)atoi(argv[2]) : 5;
+
+  static const char* const units[] = { "kg", "liter", "box", "each", "dozen", "" };
+  static const char* const stems[] = { "", "apple", "applesauce jar", "Grade A large brown eggs, free range",
+    "\xe9t\xe9 special", "water" };
+  Random random(seed);
+  InventoryStore store;
+  char sku[max_sku_length + 1];
+  string name;
+  for (size_t i = 0; i < products; i++) {
+    // distinct skus of one to seven characters
+    snprintf(sku, sizeof(sku), "%zx", i * 2654435761u % 0xFFFFFFF);
+    name = stems[random.next() % 6];
+    if (random.next() % 4 == 0)
+      name += " " + to_string(random.next() % 1000);
+    if (random.next() % 500 == 0)
+      name.append(100 + random.next() % 3000, 'x');
+    double price = random.next() % 3 == 0 ? (double)random.next() / 7919.0 : (random.next() % 100000) / 100.0;
+    if (random.next() % 50 == 0)
+      price = -price;
+    bool perishable = random.next() % 2 != 0;
+    Date expiry = perishable && random.next() % 4 != 0 ?
+      Date(2000 + random.next() % 30, 1 + random.next() % 12, 1 + random.next() % 28) : Date();
+    int quantity = (int)(random.next() % 2000) - (random.next() % 20 == 0 ? 1000 : 0);
+    store.insert(perishable ? 'P' : 'N', sku, name.c_str(), units[random.next() % 6], random.next() % 2 != 0, price,
+      quantity, (int)(random.next() % 500), expiry);
+  }
+
+  int failures = 0;
+  const char* snapshotFile = "roundtrip_check.snapshot";
+  const char* catalogFile = "roundtrip_check.catalog";
+
+  // a snapshot keeps the row order
+  InventoryStore restored;
+  if (!saveSnapshot(snapshotFile, store) || !restoreSnapshot(snapshotFile, restored) ||
+    restored.size() != store.size())
+    failures++;
+  else
+    for (size_t row = 0; row < store.size(); row++)
+      failures += !same(store, row, restored, row);
+
+  // a catalog is in sku order, so its products are matched by sku
+  InventoryStore loaded;
+  if (!saveCatalog(catalogFile, store) || !loadCatalog(catalogFile, loaded) || loaded.size() != store.size())
+    failures++;
+  else
+    for (size_t row = 0; row < store.size(); row++) {
+      size_t other = loaded.find(store.sku(row));
+      failures += other == InventoryStore::npos || !same(store, row, loaded, other);
+    }
+
+  CatalogReader reader;
+  if (!reader.open(catalogFile) || !reader.verify() || reader.size() != store.size())
+    failures++;
+  else {
+    ProductRecord record;
+    for (size_t row = 0; row < store.size(); row++)
+      failures += !reader.find(store.sku(row), record) || !same(store, row, record);
+    failures += reader.find("none", record);
+  }
+  reader.close();
+
+  // damage the first record block, which starts right after the 64-byte header
+  {
+    fstream file(catalogFile, ios::in | ios::out | ios::binary);
+    char byte;
+    file.seekg(64);
+    file.get(byte);
+    file.seekp(64);
+    file.put((char)(byte ^ 0x55));
+  }
+  failures += loadCatalog(catalogFile, loaded) || loaded.size() != 0;
+
+  remove(snapshotFile);
+  remove(catalogFile);
+
+  printf("roundtrip_check: %s, %zu products through a snapshot and a catalog, %d failures\n",
+    failures == 0 ? "ok" : "FAILED", products, failures);
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// sku_bench compares finding products by sku with a linear scan over iProduct
+// objects (iProduct::operator==) against the sku index of an InventoryStore.
+//
+// usage: sku_bench [products] [lookups]
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include "iProduct.h"
+#include "Product.h"
+#include "InventoryStore.h"
+using namespace std;
+using namespace GMS;
+
+// makes the i-th sku as a base-36 number
+void makeSku(char* sku, unsigned i) {
+  const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+  int len = 0;
+  do {
+    sku[len++] = digits[i % 36];
+    i /= 36;
+  } while (i != 0 && len < max_sku_length);
+  sku[len] = '\0';
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+  unsigned products = argc > 1 ? (unsigned)atoi(argv[1]) : 100000;
+  unsigned lookups = argc > 2 ? (unsigned)atoi(argv[2]) : 10000;
+  vector<iProduct*> catalog;
+  InventoryStore store;
+  char sku[max_sku_length + 1];
+
+  catalog.reserve(products);
+  store.reserve(products);
+  for (unsigned i = 0; i < products; i++) {
+    makeSku(sku, i);
+    catalog.push_back(new Product(sku, "product", "unit", (int)(i % 100), true, 1.0, 10));
+    store.insert('N', sku, "product", "unit", true, 1.0, (int)(i % 100), 10);
+  }
+
+  // the same pseudo-random sequence of skus is looked up both ways
+  unsigned seed = 12345;
+  unsigned long long found = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (unsigned n = 0; n < lookups; n++) {
+    seed = seed * 1103515245u + 12345u;
+    makeSku(sku, (seed >> 8) % products);
+    for (size_t i = 0; i < catalog.size(); i++) {
+      if (*catalog[i] == sku) {
+        found += catalog[i]->quantity();
+        break;
+      }
+    }
+  }
+  double scan = secondsSince(start);
+
+  seed = 12345;
+  unsigned long long indexed = 0;
+  start = chrono::steady_clock::now();
+  for (unsigned n = 0; n < lookups; n++) {
+    seed = seed * 1103515245u + 12345u;
+    makeSku(sku, (seed >> 8) % products);
+    size_t row = store.find(sku);
+    if (row != InventoryStore::npos)
+      indexed += store.quantity(row);
+  }
+  double index = secondsSince(start);
+
+  cout << "products: " << products << ", lookups: " << lookups << endl;
+  cout << "linear scan: " << scan * 1e9 / lookups << " ns/lookup" << endl;
+  cout << "sku index:   " << index * 1e9 / lookups << " ns/lookup" << endl;
+  if (found != indexed)
+    cout << "MISMATCH: " << found << " != " << indexed << endl;
+
+  for (size_t i = 0; i < catalog.size(); i++)
+    delete catalog[i];
+  return 0;
+}
@@ -0,0 +1,158 @@
+// stock_bench measures concurrent quantity updates under a skewed (hot sku) mix: every
+// thread runs the same mix of receipts, sales and quantity reads, either through a
+// single mutex around the InventoryStore (the only safe way before ConcurrentStock),
+// through a ConcurrentStock, or through a ConcurrentStock with the hot products
+// isolated on cache lines of their own. It prints one CSV line per mode and thread count:
+//
+//   mode,threads,operations,seconds,ns_per_op,mops_per_s
+//
+// usage: stock_bench [products] [operations per thread] [thread counts, e.g. 1,2,4,8,16,32]
+//
+// 90% of the operations go to the hottest 1% of the products (at least 8 products);
+// of the operations, 40% are receipts, 40% sales and 20% quantity reads.
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "InventoryStore.h"
+#include "ConcurrentStock.h"
+using namespace std;
+using namespace GMS;
+
+// a small per-thread xorshift generator
+struct Random {
+  unsigned long long state;
+  explicit Random(unsigned long long seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+  unsigned next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned)(state >> 32);
+  }
+};
+
+// the rows touched by a thread, and the operation for each (0-3 receipt, 4-7 sale, 8-9 read)
+struct Mix {
+  vector<size_t> rows;
+  vector<unsigned char> kinds;
+};
+
+// the number of hot products: the first rows of the store
+size_t hotCount(size_t products) {
+  return products / 100 < 8 ? 8 : products / 100;
+}
+
+Mix makeMix(size_t products, size_t operations, unsigned seed) {
+  Random random(seed);
+  size_t hot = hotCount(products);
+  Mix mix;
+  mix.rows.resize(operations);
+  mix.kinds.resize(operations);
+  for (size_t i = 0; i < operations; i++) {
+    mix.rows[i] = random.next() % 10 != 0 ? random.next() % hot : random.next() % products;
+    mix.kinds[i] = (unsigned char)(random.next() % 10);
+  }
+  return mix;
+}
+
+double secondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// runs body(thread index) on the given number of threads and returns the elapsed seconds
+template <typename Body>
+double run(unsigned threads, Body body) {
+  vector<thread> workers;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  for (unsigned t = 0; t < threads; t++)
+    workers.emplace_back(body, t);
+  for (thread& worker : workers)
+    worker.join();
+  return secondsSince(start);
+}
+
+void report(const char* mode, unsigned threads, unsigned long long operations, double seconds) {
+  printf("%s,%u,%llu,%.6f,%.1f,%.2f\n", mode, threads, operations, seconds, seconds * 1e9 / operations,
+    operations / seconds / 1e6);
+}
+
+int main(int argc, char* argv[]) {
+  size_t products = argc > 1 ? (size_t)atol(argv[1]) : 100000;
+  size_t operations = argc > 2 ? (size_t)atol(argv[2]) : 1000000;
+  string counts = argc > 3 ? argv[3] : "1,2,4,8,16,32";
+  vector<unsigned> threadCounts;
+  for (size_t p = 0; p < counts.size();) {
+    threadCounts.push_back((unsigned)atoi(counts.c_str() + p));
+    size_t comma = counts.find(',', p);
+    p = comma == string::npos ? counts.size() : comma + 1;
+  }
+
+  InventoryStore store;
+  char sku[max_sku_length + 1];
+  store.reserve(products);
+  for (size_t i = 0; i < products; i++) {
+    snprintf(sku, sizeof(sku), "%zu", i);
+    store.insert('N', sku, "product", "unit", true, 1.0, 1000, 10);
+  }
+
+  unsigned most = 0;
+  for (unsigned threads : threadCounts)
+    most = threads > most ? threads : most;
+  vector<Mix> mixes;
+  for (unsigned t = 0; t < most; t++)
+    mixes.push_back(makeMix(products, operations, 17 + t));
+
+  vector<size_t> hotRows(hotCount(products));
+  for (size_t i = 0; i < hotRows.size(); i++)
+    hotRows[i] = i;
+
+  printf("mode,threads,operations,seconds,ns_per_op,mops_per_s\n");
+  for (unsigned threads : threadCounts) {
+    mutex lock;
+    vector<long long> sums(most);
+    double seconds = run(threads, [&](unsigned t) {
+      const Mix& mix = mixes[t];
+      long long sum = 0;
+      for (size_t i = 0; i < operations; i++) {
+        lock_guard<mutex> guard(lock);
+        size_t row = mix.rows[i];
+        if (mix.kinds[i] < 4)
+          sum += store.receive(row, 1);
+        else if (mix.kinds[i] < 8)
+          store.quantity(row, store.quantity(row) > 0 ? store.quantity(row) - 1 : 0);
+        else
+          sum += store.quantity(row) + store.qtyNeeded(row);
+      }
+      sums[t] = sum;
+    });
+    report("global_mutex", threads, (unsigned long long)operations * threads, seconds);
+
+    ConcurrentStock stock(store);
+    auto updates = [&](unsigned t) {
+      const Mix& mix = mixes[t];
+      long long sum = 0;
+      for (size_t i = 0; i < operations; i++) {
+        size_t row = mix.rows[i];
+        if (mix.kinds[i] < 4)
+          sum += stock.receive(row, 1);
+        else if (mix.kinds[i] < 8)
+          sum += stock.sell(row, 1);
+        else
+          sum += stock.quantity(row) + stock.qtyNeeded(row);
+      }
+      sums[t] = sum;
+    };
+    seconds = run(threads, updates);
+    report("concurrent_stock", threads, (unsigned long long)operations * threads, seconds);
+
+    stock.isolate(hotRows);
+    seconds = run(threads, updates);
+    stock.settle();
+    report("concurrent_isolated", threads, (unsigned long long)operations * threads, seconds);
+  }
+  return 0;
+}
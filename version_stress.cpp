@@ -0,0 +1,109 @@
+// version_stress checks that readers of a VersionedStore never see a torn version. The
+// writer keeps moving units from one product to another, in batches, and publishes after
+// each batch, so the total quantity on hand of every published version is the same; the
+// reader threads keep opening Readers and check that
+//
+//   - the total quantity of the version they see is that total,
+//   - the versions they see never go back,
+//   - a version they keep open does not change while the writer publishes.
+//
+// It prints one summary line and exits with a non-zero status if any check failed. Build it
+// with ThreadSanitizer to check the reclamation as well:
+//
+//   make clean && make CXXFLAGS="-std=c++17 -O1 -g -fsanitize=thread" version_stress
+//
+// usage: version_stress [products] [seconds] [readers]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "InventoryStore.h"
+#include "VersionedStore.h"
+using namespace std;
+using namespace GMS;
+
+// a small per-thread xorshift generator
+struct Random {
+  unsigned long long state;
+  explicit Random(unsigned long long seed) : state(seed * 0x9E3779B97F4A7C15ULL + 1) {}
+  unsigned next() {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return (unsigned)(state >> 32);
+  }
+};
+
+long long totalQuantity(const StockImage& image) {
+  long long total = 0;
+  for (size_t row = 0; row < image.size(); row++)
+    total += image.quantity(row);
+  return total;
+}
+
+int main(int argc, char* argv[]) {
+  size_t products = argc > 1 ? (size_t)atol(argv[1]) : 20000;
+  double seconds = argc > 2 ? atof(argv[2]) : 2.0;
+  unsigned readers = argc > 3 ? (unsigned)atoi(argv[3]) : 3;
+  if (products < 2)
+    products = 2;
+
+  InventoryStore store;
+  char sku[max_sku_length + 1];
+  store.reserve(products);
+  for (size_t i = 0; i < products; i++) {
+    snprintf(sku, sizeof(sku), "%zu", i);
+    store.insert('N', sku, "product", "unit", true, 1.0, 1000, 10);
+  }
+  const long long total = (long long)products * 1000;
+
+  VersionedStore versions(store);
+  atomic<bool> stop(false);
+  atomic<unsigned long long> reads(0), torn(0), backwards(0), changed(0);
+  vector<thread> threads;
+  for (unsigned t = 0; t < readers; t++) {
+    threads.emplace_back([&]() {
+      unsigned long long last = 0;
+      while (!stop.load()) {
+        VersionedStore::Reader reader(versions);
+        if (reader->version() < last)
+          backwards++;
+        last = reader->version();
+        long long first = totalQuantity(*reader);
+        if (first != total)
+          torn++;
+        // read the version again, after the writer had time to publish over it
+        this_thread::yield();
+        if (totalQuantity(*reader) != first || reader->version() != last)
+          changed++;
+        reads++;
+      }
+    });
+  }
+
+  Random random(7);
+  unsigned long long publishes = 0;
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  while (chrono::duration<double>(chrono::steady_clock::now() - start).count() < seconds) {
+    for (int i = 0; i < 100; i++) {
+      size_t from = random.next() % products, to = random.next() % products;
+      int units = (int)(random.next() % 5) + 1;
+      versions.quantity(from, store.quantity(from) - units);
+      versions.quantity(to, store.quantity(to) + units);
+    }
+    versions.publish();
+    publishes++;
+  }
+  stop = true;
+  for (thread& reader : threads)
+    reader.join();
+  size_t retired = versions.reclaim();
+
+  bool ok = torn == 0 && backwards == 0 && changed == 0 && retired == 0;
+  printf("version_stress: %s, %llu publishes, %llu reads by %u readers, %llu torn, %llu backwards, %llu changed, "
+    "%zu retired left\n", ok ? "ok" : "FAILED", publishes, reads.load(), readers, torn.load(), backwards.load(),
+    changed.load(), retired);
+  return ok ? 0 : 1;
+}